@@ -3,11 +3,205 @@
  * @brief Portable configuration file
  * @author John Doe (jdoe35087@gmail.com)
  * @details This file imports the configuration header from the portable
- * layer to the operating system folder
+ * layer to the operating system folder, and supplies default values for
+ * the kernel options the portable layer did not define.
  *************************************************************************/
 #ifndef H35FB3D3C_A33A_41DD_982A_5A216B9FCD28
 #define H35FB3D3C_A33A_41DD_982A_5A216B9FCD28
 
 #include "../portable/config.h"
 
+/**
+ * @defgroup os_config Kernel Configuration
+ * @brief Kernel options with default values
+ * @details Every option in this module can be overridden by defining it
+ * in the portable configuration file.
+ */
+
+/**
+ * @ingroup os_config
+ * @{
+ */
+
+/**
+ * @brief Number of thread priority levels
+ * @details The ready queue keeps one list per priority level, so priorities
+ * range from 0 (highest) to OS_PRIO_COUNT - 1 (lowest). The idle thread runs
+ * at @ref OS_PRIO_LOWEST, which has to be smaller than this value.
+ */
+#ifndef OS_PRIO_COUNT
+#define OS_PRIO_COUNT 				( OS_PRIO_LOWEST + 1 )
+#endif
+
+/**
+ * @brief Default round-robin time slice of a thread, in ticks
+ * @details A thread is rotated behind the other ready threads of its priority
+ * once it has run for this many ticks. 0 disables rotation by the tick, see
+ * @ref osThreadSetTimeSlice.
+ */
+#ifndef OS_TIME_SLICE_DEFAULT
+#define OS_TIME_SLICE_DEFAULT 		1
+#endif
+
+/**
+ * @brief Enables the earliest-deadline-first scheduling class
+ * @details When set to 1, threads can be given a relative deadline and a period
+ * by calling @ref osThreadSetDeadline. Such threads run at priority
+ * @ref OS_EDF_PRIORITY, and the ready threads of that priority are ordered by
+ * their absolute deadline instead of in round-robin.
+ */
+#ifndef OS_USE_EDF
+#define OS_USE_EDF 					0
+#endif
+
+/**
+ * @brief The priority level reserved for earliest-deadline-first threads
+ * @details Threads of higher priorities preempt EDF threads, and EDF threads
+ * preempt threads of lower priorities, as with fixed priorities. No other thread
+ * may be created at, or set to, this priority, and it must not be used as a
+ * mutex ceiling or as a background priority. A thread that inherits it through
+ * a mutex or a client runs ahead of the EDF threads until it gives it back.
+ */
+#ifndef OS_EDF_PRIORITY
+#define OS_EDF_PRIORITY 			( OS_PRIO_LOWEST / 2 )
+#endif
+
+/**
+ * @brief Enables CPU budget enforcement
+ * @details When set to 1, threads can be given a CPU budget and a replenishment
+ * period by calling @ref osThreadSetBudget, following a simplified sporadic
+ * server. A thread that uses up its budget runs at a background priority until
+ * the budget is replenished.
+ */
+#ifndef OS_USE_CPU_BUDGET
+#define OS_USE_CPU_BUDGET 			0
+#endif
+
+/**
+ * @brief Counts the leading zeros of a non-zero 32 bit word
+ * @details Used by the ready queue to find the highest ready priority.
+ * Ports with a dedicated instruction (e.g. CLZ) should map it here.
+ */
+#ifndef OS_CLZ
+#define OS_CLZ(word) 				( (osCounter_t) __builtin_clz(word) )
+#endif
+
+/**
+ * @brief Enables the atomic fast paths of kernel objects
+ * @details When set to 1, uncontended operations on kernel objects use
+ * @ref OS_ATOMIC_CAS instead of entering a critical section, and only fall back
+ * to a critical section when threads have to be blocked or readied.
+ */
+#ifndef OS_USE_ATOMICS
+#define OS_USE_ATOMICS 				0
+#endif
+
+/**
+ * @brief Atomically replaces a word if it holds an expected value
+ * @details Evaluates to true if the word at address was equal to expected and has
+ * been replaced by desired, false otherwise. Ports should map it to a CAS
+ * instruction or an LL/SC loop (e.g. LDREX/STREX), the default uses the compiler
+ * builtin.
+ */
+#ifndef OS_ATOMIC_CAS
+#define OS_ATOMIC_CAS(address, expected, desired) \
+	__sync_bool_compare_and_swap( (address), (expected), (desired) )
+#endif
+
+/**
+ * @brief Orders memory accesses around a lock-free read or update
+ * @details Used by the sequence counter that protects @ref systemTime. The
+ * default only stops the compiler from reordering the accesses, which is
+ * enough on a single core. Ports with weakly ordered memory should map it to
+ * a hardware barrier.
+ */
+#ifndef OS_MEMORY_BARRIER
+#define OS_MEMORY_BARRIER() 		__asm__ volatile( "" ::: "memory" )
+#endif
+
+/**
+ * @brief Number of slots in a timing wheel, must be a power of two
+ * @details Thread timeouts and timer expiries are hashed into the slots by
+ * their wake up time. The tick handler only visits the slot of the current
+ * tick, so larger wheels mean fewer items per visited slot at the cost of
+ * one list header per slot for each of the two wheels.
+ */
+#ifndef OS_TIMING_WHEEL_SIZE
+#define OS_TIMING_WHEEL_SIZE 		32
+#endif
+
+#if ( OS_TIMING_WHEEL_SIZE & ( OS_TIMING_WHEEL_SIZE - 1 ) ) != 0
+#error "OS_TIMING_WHEEL_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Enables tickless idle
+ * @details When set to 1, the idle thread stops the periodic tick whenever it
+ * is the only ready thread, and asks the portable layer for a single one-shot
+ * wake-up at the earliest thread timeout or timer expiry, see
+ * @ref port_suppressTicks.
+ */
+#ifndef OS_USE_TICKLESS_IDLE
+#define OS_USE_TICKLESS_IDLE 		0
+#endif
+
+/**
+ * @brief Minimum number of idle ticks worth suppressing the tick for
+ * @details Shorter idle periods are spent in the idle loop with the periodic
+ * tick running, since reprogramming the tick timer has a cost of its own.
+ */
+#ifndef OS_TICKLESS_MIN_IDLE_TICKS
+#define OS_TICKLESS_MIN_IDLE_TICKS 	2
+#endif
+
+/**
+ * @brief Enables the kernel interrupt priority ceiling
+ * @details When set to 1, critical sections only mask the interrupts with a
+ * logical priority up to @ref OS_KERNEL_INTERRUPT_CEILING by calling
+ * @ref port_setInterruptMask, instead of masking all interrupts. Interrupts above
+ * the ceiling are never delayed by the kernel, but must not call any kernel
+ * function.
+ */
+#ifndef OS_USE_INTERRUPT_CEILING
+#define OS_USE_INTERRUPT_CEILING 	0
+#endif
+
+#if OS_USE_INTERRUPT_CEILING
+/**
+ * @brief The highest logical interrupt priority allowed to call the kernel
+ * @details Logical interrupt priorities start from 1 and grow with urgency, thread
+ * contexts are at 0. The portable layer maps them onto the priorities of the
+ * interrupt controller. Has to be defined by the portable layer.
+ */
+#ifndef OS_KERNEL_INTERRUPT_CEILING
+#error "OS_KERNEL_INTERRUPT_CEILING must be defined when OS_USE_INTERRUPT_CEILING is 1"
+#endif
+
+#if OS_KERNEL_INTERRUPT_CEILING < 1
+#error "OS_KERNEL_INTERRUPT_CEILING must be at least 1"
+#endif
+#endif
+
+/**
+ * @brief Rounds the memory of queues up to a power of two
+ * @details When set to 1, the circular buffer of a queue is sized to the
+ * smallest power of two that holds the requested number of bytes plus the
+ * byte that is always left empty, so read and write positions wrap with a
+ * mask instead of a compare. Costs up to half of the buffer in unused memory.
+ */
+#ifndef OS_QUEUE_SIZE_POWER_OF_TWO
+#define OS_QUEUE_SIZE_POWER_OF_TWO 	0
+#endif
+
+/**
+ * @brief Maximum number of objects a thread can wait for at once
+ * @details @ref osWaitAny keeps one list item per object on the stack of the
+ * calling thread.
+ */
+#ifndef OS_WAIT_ANY_MAX_OBJECTS
+#define OS_WAIT_ANY_MAX_OBJECTS 	8
+#endif
+
+/** @} */
+
 #endif /* H35FB3D3C_A33A_41DD_982A_5A216B9FCD28 */
@@ -17,6 +17,26 @@
  */
 #define NREENT
 
+/**
+ * @brief Returns the lower word of the system time
+ * @details Timeouts and timer expiries are stored as the lower word of the system
+ * time they wake up at, and compared with @ref TIME_IS_REACHED.
+ */
+#define TIME_NOW() \
+	( (osCounter_t) systemTime )
+
+/**
+ * @brief Checks if a wake up time has been reached, with wrap around
+ * @param time the wake up time, the lower word of the system time
+ * @param now the lower word of the current system time
+ * @retval true if time is not later than now
+ * @retval false if time is later than now
+ * @details The two times have to be less than half of the range of osCounter_t
+ * apart, which limits timeouts and timer periods to that range.
+ */
+#define TIME_IS_REACHED(time, now) \
+	( (osCounter_t)( (now) - (time) ) <= ( (osCounter_t) -1 ) / 2 )
+
 /** ************************************************************************************************
  * @defgroup os_internal_list List
  */
@@ -45,6 +65,24 @@ void list_remove( void* item );
 
 #include "inline_functions/list.h"
 
+/** ************************************************************************************************
+ * @defgroup os_internal_wheel Timing Wheel
+ */
+
+/**
+ * @ingroup os_internal_wheel
+ * @{
+ */
+void timingWheel_init			( TimingWheel_t* wheel );
+NREENT void timingWheel_insert	( TimingWheel_t* wheel, PrioritizedListItem_t* item, osCounter_t time );
+NREENT void timingWheel_takeExpired	( TimingWheel_t* wheel, osCounter_t ticks, NotPrioritizedList_t* expired );
+#if OS_USE_TICKLESS_IDLE
+NREENT osCounter_t timingWheel_getTicksToNext( TimingWheel_t* wheel );
+#endif
+/** ************************************************************************************************
+ * @}
+ */
+
 /** ************************************************************************************************
  * @defgroup os_internal_heap Heap
  */
@@ -63,6 +101,20 @@ void list_remove( void* item );
 	( ((size) % OS_MEMORY_ALIGNMENT) ? \
 		((size) + OS_MEMORY_ALIGNMENT - (size) % OS_MEMORY_ALIGNMENT) : (size) )
 
+/**
+ * @brief Rounds up the size of a fixed size item to the distance between two slots
+ * @param size the item size in bytes
+ * @return size rounded up to a whole number of words, or size itself if it is
+ * smaller than a word
+ * @details A type is aligned to a power of two that divides its size, so slots
+ * of this size keep every item at its natural alignment, and the items of a
+ * word or more are copied between word aligned addresses. Small items are not
+ * padded to the heap alignment.
+ */
+#define ITEM_ROUND_UP_SIZE(size) \
+	( ((size) < sizeof(osCounter_t)) ? (size) : \
+		((size) + sizeof(osCounter_t) - 1) / sizeof(osCounter_t) * sizeof(osCounter_t) )
+
 /**
  * @brief Checks if the memory address or the memory block size is aligned
  * @param value a memory address or the size of a memory block
@@ -126,16 +178,119 @@ NREENT void memory_returnToHeap			( void* p, MemoryList_t* source );
  */
 void threadReturnHook( void );
 void thread_init( Thread_t* thread );
+OS_INLINE NREENT void thread_readyListInit( void );
+OS_INLINE NREENT osBool_t thread_isReady( Thread_t* thread );
+OS_INLINE NREENT osCounter_t thread_getHighestReadyPriority( void );
+OS_INLINE NREENT void thread_readyInsert( Thread_t* thread );
+OS_INLINE NREENT void thread_readyRemove( Thread_t* thread );
 OS_INLINE NREENT void thread_setNew( void );
+OS_INLINE NREENT osBool_t thread_isPreemptionNeeded( void );
+OS_INLINE NREENT void thread_requestReschedule( void );
 NREENT void thread_makeReady( Thread_t* thread );
 NREENT void thread_makeAllReady( PrioritizedList_t* list );
 NREENT void thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait );
+NREENT void thread_reschedule( void );
+NREENT void thread_readyTimedOut( osCounter_t ticks );
+NREENT void thread_changePriority( Thread_t* thread, osCounter_t priority );
+NREENT void thread_setBasePriority( Thread_t* thread, osCounter_t priority );
+#if OS_USE_CPU_BUDGET
+NREENT void thread_chargeBudget( void );
+NREENT void thread_replenishBudgets( osCounter_t ticks );
+#endif
 
 /** ************************************************************************************************
  * @}
  */
 #include "inline_functions/thread.h"
 
+/** ************************************************************************************************
+ * @defgroup os_internal_os Operating System Control
+ */
+
+/**
+ * @ingroup os_internal_os
+ * @{
+ */
+
+NREENT void os_advanceTime( osCounter_t ticks );
+#if OS_USE_TICKLESS_IDLE
+/**
+ * @brief Idle period returned by @ref os_getIdleTicks and @ref timingWheel_getTicksToNext
+ * when nothing waits for a timeout
+ */
+#define OS_TICKLESS_INFINITE_IDLE 	( (osCounter_t) -1 )
+
+NREENT osCounter_t os_getIdleTicks( void );
+OS_NORETURN void os_idleTask( void );
+#endif
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_mutex Mutex
+ */
+
+/**
+ * @ingroup os_internal_mutex
+ * @{
+ */
+/**
+ * @brief The priority ceiling of a mutex that has none
+ */
+#define MUTEX_NO_CEILING 	( (osCounter_t) -1 )
+
+void mutex_init( MutexBase_t* mutex, osCounter_t ceiling );
+NREENT void mutex_acquire( MutexBase_t* mutex, Thread_t* thread );
+NREENT void mutex_register( MutexBase_t* mutex );
+NREENT void mutex_handOff( MutexBase_t* mutex );
+NREENT void mutex_inherit( MutexBase_t* mutex, osCounter_t priority );
+NREENT void mutex_updatePriority( Thread_t* thread );
+NREENT void mutex_abandonWait( Thread_t* thread );
+NREENT void mutex_releaseAll( Thread_t* thread );
+NREENT void mutex_destroy( MutexBase_t* mutex );
+NREENT osBool_t mutex_blockCurrent( MutexBase_t* mutex, osCounter_t timeout );
+#if OS_USE_ATOMICS
+NREENT void mutex_settle( MutexBase_t* mutex, Thread_t* previous );
+#endif
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_semaphore Semaphore
+ */
+
+/**
+ * @ingroup os_internal_semaphore
+ * @{
+ */
+#if OS_USE_ATOMICS
+/**
+ * @brief Counter value of a semaphore that threads may be waiting for
+ * @details Set by a thread before it blocks, or waits for the semaphore in
+ * @ref osWaitAny, so that the atomic increment of a concurrent
+ * @ref osSemaphorePost fails and the post takes the path that readies the
+ * thread. It counts as 0, and is only cleared by the post that finds no thread
+ * waiting any more.
+ */
+#define SEMAPHORE_CONTENDED 			( (osCounter_t) -1 )
+
+/**
+ * @brief Returns the value of the counter of a semaphore
+ * @param semaphore pointer to the semaphore control block
+ */
+#define SEMAPHORE_COUNT(semaphore) \
+	( (semaphore)->counter == SEMAPHORE_CONTENDED ? 0 : (semaphore)->counter )
+
+osBool_t semaphore_tryDecrement( Semaphore_t* semaphore );
+#else
+#define SEMAPHORE_COUNT(semaphore) 		( (semaphore)->counter )
+#endif
+/** ************************************************************************************************
+ * @}
+ */
+
 /** ************************************************************************************************
  * @defgroup os_internal_queue Queue
  */
@@ -147,8 +302,96 @@ NREENT void thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, v
 void queue_solveEquation( Queue_t* queue );
 void queue_read( Queue_t* queue, void* data, osCounter_t size );
 void queue_write( Queue_t* queue, const void* data, osCounter_t size );
+void queue_send( Queue_t* queue, const void* data, osCounter_t size );
 osCounter_t queue_getUsedSize( Queue_t* queue );
 osCounter_t queue_getFreeSize( Queue_t* queue );
+void queue_getRegion( Queue_t* queue, osCounter_t position, osCounter_t size, osQueueRegion_t* region );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_message_queue Message Queue
+ */
+
+/**
+ * @ingroup os_internal_message_queue
+ * @{
+ */
+void messageQueue_write( MessageQueue_t* queue, const void* data );
+void messageQueue_read( MessageQueue_t* queue, void* data );
+void messageQueue_solveEquation( MessageQueue_t* queue );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_spsc_ring Single-Producer Single-Consumer Ring
+ */
+
+/**
+ * @ingroup os_internal_spsc_ring
+ * @{
+ */
+void spscRing_wakeConsumer( SpscRing_t* ring );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_mpsc_ring Multi-Producer Single-Consumer Ring
+ */
+
+/**
+ * @ingroup os_internal_mpsc_ring
+ * @{
+ */
+osBool_t mpscRing_claim( MpscRing_t* ring, osCounter_t* slot );
+void mpscRing_wakeConsumer( MpscRing_t* ring );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_stream Stream Buffer
+ */
+
+/**
+ * @ingroup os_internal_stream
+ * @{
+ */
+void stream_serveReaders( StreamBuffer_t* stream );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_msg Synchronous Message Passing
+ */
+
+/**
+ * @ingroup os_internal_msg
+ * @{
+ */
+osCounter_t msg_copy( void* destination, osCounter_t capacity, const void* source, osCounter_t size );
+NREENT void msg_inherit( Thread_t* server, osCounter_t priority );
+NREENT void msg_abandonWait( Thread_t* client );
+/** ************************************************************************************************
+ * @}
+ */
+
+/** ************************************************************************************************
+ * @defgroup os_internal_wait_any Wait for Multiple Objects
+ */
+
+/**
+ * @ingroup os_internal_wait_any
+ * @{
+ */
+osBool_t waitAny_isReady( const osWaitObject_t* object );
+NotPrioritizedList_t* waitAny_prepare( const osWaitObject_t* object );
+NREENT void waitAny_notify( NotPrioritizedList_t* selectors );
+NREENT void waitAny_abandon( Thread_t* thread );
 /** ************************************************************************************************
  * @}
  */
@@ -160,6 +403,7 @@ void timer_init( Timer_t* timer, osTimerMode_t mode, osCounter_t period, osCode_
 	TimerPriorityBlock_t* priorityBlock );
 NREENT TimerPriorityBlock_t* timer_createPriority( osCounter_t priority );
 NREENT TimerPriorityBlock_t* timer_searchPriority( osCounter_t priority );
+NREENT void timer_readyExpired( osCounter_t ticks );
 void timerTask( TimerPriorityBlock_t* volatile priorityBlock );
 
 /**
@@ -183,6 +427,75 @@ void port_yield( void );
 
 osByte_t* port_makeFakeContext(	osByte_t* stack, osCounter_t stackSize,
 		osCode_t code, const void* argument );
+
+#if OS_USE_INTERRUPT_CEILING
+/**
+ * @brief Masks interrupts up to a logical priority
+ * @param ceiling interrupts with a logical priority up to this value are masked,
+ * 0 unmasks all interrupts
+ * @details Used by critical sections instead of @ref port_disableInterrupts and
+ * @ref port_enableInterrupts, e.g. by writing BASEPRI on ARMv7-M.
+ */
+void port_setInterruptMask( osCounter_t ceiling );
+
+/**
+ * @brief Returns the logical priority of the running interrupt
+ * @return the logical priority of the running interrupt, 0 in thread contexts and
+ * in the main stack context before the kernel started
+ */
+osCounter_t port_getInterruptPriority( void );
+#endif
+
+#if OS_USE_TICKLESS_IDLE
+/**
+ * @brief Sleeps with the periodic tick stopped
+ * @param ticks the maximum number of ticks to sleep, 0 if no thread or timer
+ * is waiting for a timeout
+ * @return the number of whole ticks that elapsed while the tick was stopped
+ * @details Called by the idle thread inside a critical section. The port stops
+ * the periodic tick, arms a one-shot timer for at most the given number of
+ * ticks (clamping it to the range of the hardware timer), and sleeps until the
+ * one-shot timer or any other interrupt wakes the CPU. Before returning it
+ * restarts the periodic tick so that the next tick stays aligned to the ticks
+ * already elapsed. Pending interrupts are serviced after the idle thread leaves
+ * the critical section.
+ */
+osCounter_t port_suppressTicks( osCounter_t ticks );
+
+/**
+ * @brief Sleeps until the next interrupt
+ * @details Called by the idle thread inside a critical section when the tick
+ * cannot be suppressed. The port sleeps with the periodic tick running, e.g. by
+ * WFI on ARMv7-M, and returns as soon as an interrupt is pending, even though
+ * it is masked. The interrupt is serviced after the idle thread leaves the
+ * critical section.
+ */
+void port_sleep( void );
+#endif
 /** @} ********************************************************************/
 
+/**
+ * @ingroup os_internal_thread
+ * @{
+ */
+#if OS_USE_INTERRUPT_CEILING
+/**
+ * @brief Masks the interrupts that are allowed to call the kernel
+ * @details Only interrupts up to @ref OS_KERNEL_INTERRUPT_CEILING can call the
+ * kernel, the assertion catches the ones above it.
+ */
+#define CRITICAL_MASK_INTERRUPTS() \
+	do { \
+		OS_ASSERT( port_getInterruptPriority() <= OS_KERNEL_INTERRUPT_CEILING ); \
+		port_setInterruptMask( OS_KERNEL_INTERRUPT_CEILING ); \
+	} while( 0 )
+
+/** @brief Unmasks the interrupts masked by @ref CRITICAL_MASK_INTERRUPTS */
+#define CRITICAL_UNMASK_INTERRUPTS() 	port_setInterruptMask( 0 )
+#else
+#define CRITICAL_MASK_INTERRUPTS() 		port_disableInterrupts()
+#define CRITICAL_UNMASK_INTERRUPTS() 	port_enableInterrupts()
+#endif
+/** @} */
+
 #endif /* HD8FEBD31_8511_4019_860C_C3532E53EBF0 */
@@ -25,7 +25,11 @@ extern "C" {
  */
 void 			osInit						( void );
 void 			osStart						( void );
-osCounter_t 	osGetTime					( void );
+osTime_t 		osGetTime					( void );
+void 			osInterruptEnter			( void );
+void 			osInterruptExit				( void );
+osCounter_t 	osGetRescheduleRequestCounter( void );
+osCounter_t 	osGetRescheduleMergedCounter( void );
 /** @} *********************************************************************************************/
 /** ************************************************************************************************
  * @defgroup os_thread Thread
@@ -46,9 +50,25 @@ void 			osThreadSetPriority			( osHandle_t thread, osCounter_t priority );
 osHandle_t 		osThreadGetCurrentHandle	( void );
 void 			osThreadDelay				( osCounter_t timeout );
 void 			osThreadYield				( void );
+void 			osThreadSetTimeSlice		( osHandle_t thread, osCounter_t ticks );
+osCounter_t 	osThreadGetTimeSlice		( osHandle_t thread );
+osCounter_t 	osThreadGetTimeSliceCounter	( osHandle_t thread );
+osCounter_t 	osThreadSetPreemptionThreshold( osHandle_t thread, osCounter_t threshold );
+osCounter_t 	osThreadGetPreemptionThreshold( osHandle_t thread );
+#if OS_USE_EDF
+void 			osThreadSetDeadline			( osHandle_t thread, osCounter_t deadline, osCounter_t period );
+void 			osThreadWaitNextPeriod		( void );
+osCounter_t 	osThreadGetDeadlineMissCounter( osHandle_t thread );
+#endif
+#if OS_USE_CPU_BUDGET
+void 			osThreadSetBudget			( osHandle_t thread, osCounter_t budget, osCounter_t period, osCounter_t backgroundPriority );
+osCounter_t 	osThreadGetBudgetOverrunCounter( osHandle_t thread );
+#endif
 void 			osThreadEnterCritical		( void );
 void 			osThreadExitCritical		( void );
 osCounter_t		osThreadGetCriticalNesting	( void );
+void 			osSchedulerSuspend			( void );
+void 			osSchedulerResume			( void );
 void 			osThreadSetCriticalNesting	( osCounter_t counter );
 /** @} *********************************************************************************************/
 /** ************************************************************************************************
@@ -86,6 +106,104 @@ osBool_t 		osQueueSend					( osHandle_t queue, const void *data, osCounter_t siz
 osBool_t 		osQueuePeekReceive			( osHandle_t queue, osCounter_t size );
 osBool_t 		osQueueReceiveNonBlock		( osHandle_t queue, void *data, osCounter_t size );
 osBool_t 		osQueueReceive				( osHandle_t queue, void *data, osCounter_t size, osCounter_t timeout );
+osBool_t 		osQueueSendReserve			( osHandle_t queue, osCounter_t size, osQueueRegion_t *region );
+void 			osQueueSendCommit			( osHandle_t queue, osCounter_t size );
+osBool_t 		osQueueReceiveAcquire		( osHandle_t queue, osCounter_t size, osQueueRegion_t *region );
+void 			osQueueReceiveRelease		( osHandle_t queue, osCounter_t size );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_message_queue Message Queue
+ * @ingroup os_api
+ * @brief Passing messages of a fixed size between threads or interrupts.
+ */
+/**
+ * @ingroup os_message_queue
+ * @{
+ */
+osHandle_t 		osMessageQueueCreate		( osCounter_t itemSize, osCounter_t itemCount );
+void 			osMessageQueueDelete		( osHandle_t queue );
+void 			osMessageQueueReset			( osHandle_t queue );
+osCounter_t 	osMessageQueueGetCount		( osHandle_t queue );
+osCounter_t 	osMessageQueueGetFreeCount	( osHandle_t queue );
+osBool_t 		osMessageQueueSendNonBlock	( osHandle_t queue, const void *data );
+osBool_t 		osMessageQueueSend			( osHandle_t queue, const void *data, osCounter_t timeout );
+osBool_t 		osMessageQueueReceiveNonBlock( osHandle_t queue, void *data );
+osBool_t 		osMessageQueueReceive		( osHandle_t queue, void *data, osCounter_t timeout );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_spsc_ring Single-Producer Single-Consumer Ring
+ * @ingroup os_api
+ * @brief Streaming bytes from one interrupt or thread to one thread without locking.
+ */
+/**
+ * @ingroup os_spsc_ring
+ * @{
+ */
+osHandle_t 		osSpscRingCreate			( osCounter_t size );
+void 			osSpscRingDelete			( osHandle_t ring );
+osCounter_t 	osSpscRingGetUsedSize		( osHandle_t ring );
+osCounter_t 	osSpscRingWrite				( osHandle_t ring, const void *data, osCounter_t size );
+osCounter_t 	osSpscRingRead				( osHandle_t ring, void *data, osCounter_t size );
+osCounter_t 	osSpscRingReceive			( osHandle_t ring, void *data, osCounter_t size, osCounter_t timeout );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_mpsc_ring Multi-Producer Single-Consumer Ring
+ * @ingroup os_api
+ * @brief Passing items from several interrupts or threads to one thread without locking out interrupts.
+ */
+/**
+ * @ingroup os_mpsc_ring
+ * @{
+ */
+osHandle_t 		osMpscRingCreate			( osCounter_t itemSize, osCounter_t itemCount );
+void 			osMpscRingDelete			( osHandle_t ring );
+osBool_t 		osMpscRingWrite				( osHandle_t ring, const void *data );
+osBool_t 		osMpscRingRead				( osHandle_t ring, void *data );
+osBool_t 		osMpscRingReceive			( osHandle_t ring, void *data, osCounter_t timeout );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_stream Stream Buffer
+ * @ingroup os_api
+ * @brief Passing a stream of bytes to a thread that consumes whatever has arrived.
+ */
+/**
+ * @ingroup os_stream
+ * @{
+ */
+osHandle_t 		osStreamCreate				( osCounter_t size, osCounter_t triggerLevel );
+void 			osStreamDelete				( osHandle_t stream );
+void 			osStreamReset				( osHandle_t stream );
+void 			osStreamSetTriggerLevel		( osHandle_t stream, osCounter_t triggerLevel );
+osCounter_t 	osStreamGetUsedSize			( osHandle_t stream );
+osCounter_t 	osStreamSend				( osHandle_t stream, const void *data, osCounter_t size );
+osCounter_t 	osStreamReceiveNonBlock		( osHandle_t stream, void *data, osCounter_t maxLen );
+osCounter_t 	osStreamReceive				( osHandle_t stream, void *data, osCounter_t maxLen, osCounter_t timeout );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_msg Synchronous Message Passing
+ * @ingroup os_api
+ * @brief Sending a request to a server thread and waiting for its reply.
+ */
+/**
+ * @ingroup os_msg
+ * @{
+ */
+osHandle_t 		osMsgChannelCreate			( void );
+void 			osMsgChannelDelete			( osHandle_t channel );
+osBool_t 		osMsgSend					( osHandle_t channel, const void *request, osCounter_t requestSize, void *reply, osCounter_t *replySize, osCounter_t timeout );
+osHandle_t 		osMsgReceive				( osHandle_t channel, void *data, osCounter_t *size, osCounter_t timeout );
+osBool_t 		osMsgReply					( osHandle_t client, const void *reply, osCounter_t size );
+/** @} *********************************************************************************************/
+/** ************************************************************************************************
+ * @defgroup os_wait_any Wait for Multiple Objects
+ * @ingroup os_api
+ * @brief Waiting for any of several queues, semaphores, mutexes and signals.
+ */
+/**
+ * @ingroup os_wait_any
+ * @{
+ */
+osCounter_t 	osWaitAny					( const osWaitObject_t *objects, osCounter_t count, osCounter_t timeout );
 /** @} *********************************************************************************************/
 /** ************************************************************************************************
  * @defgroup os_semaphore Semaphore
@@ -115,6 +233,7 @@ osBool_t 		osSemaphoreWait				( osHandle_t semaphore, osCounter_t timeout );
  * @{
  */
 osHandle_t 		osMutexCreate				( void );
+osHandle_t 		osMutexCreateCeiling		( osCounter_t priority );
 void 			osMutexDelete				( osHandle_t mutex );
 osBool_t 		osMutexPeekLock				( osHandle_t mutex );
 osBool_t 		osMutexLockNonBlock			( osHandle_t mutex );
@@ -23,16 +23,62 @@ extern MemoryList_t 				kernelMemoryList;	/**< @brief Memory allocated to the ke
 extern NotPrioritizedList_t			timerPriorityList;	/**< @brief  */
 
 /**
- * @brief The system timeout list.
- * @details Threads that do not block permanently are put into this list.
+ * @brief The system timeout wheel.
+ * @details Threads that do not block permanently are put into this wheel.
  */
-extern PrioritizedList_t 			threads_timed;
-extern PrioritizedList_t 			threads_ready;		/**< @brief The ready list */
+extern TimingWheel_t 				threads_timed;
+
+/**
+ * @brief The system timer wheel.
+ * @details Running timers are put into this wheel until they expire.
+ */
+extern TimingWheel_t 				timers_timed;
+
+#if OS_USE_CPU_BUDGET
+/**
+ * @brief The budget replenishment wheel.
+ * @details Threads that consumed part of their CPU budget are put into this wheel
+ * until the budget is replenished.
+ */
+extern TimingWheel_t 				budgets_timed;
+#endif
+extern ReadyList_t 					threads_ready;		/**< @brief The ready queue */
 
 extern Thread_t 					idleThread;			/**< @brief The thread control block form the idle thread */
 extern Thread_t *volatile 			currentThread;		/**< @brief Points to the current thread */
 extern Thread_t *volatile 			nextThread;			/**< @brief Points to the next thread to be scheduled */
-extern volatile osCounter_t			systemTime;			/**< @brief The system time */
+extern volatile osTime_t			systemTime;			/**< @brief The system time */
+
+/**
+ * @brief The sequence counter of the system time.
+ * @details Incremented before and after every update of @ref systemTime, so that it
+ * is odd while an update is in progress. This allows @ref osGetTime to read the
+ * system time without entering a critical section.
+ */
+extern volatile osCounter_t			systemTimeSequence;
+
+/**
+ * @brief Set when a reschedule has been requested but not yet performed.
+ * @details Wake-up paths set this flag instead of rescheduling immediately, see
+ * @ref thread_requestReschedule.
+ */
+extern volatile osBool_t 			reschedulePending;
+extern volatile osCounter_t 		rescheduleRequestCounter;	/**< @brief Number of reschedule requests */
+extern volatile osCounter_t 		rescheduleMergedCounter;	/**< @brief Number of requests merged into a pending one */
+
+/**
+ * @brief The interrupt nesting counter.
+ * @details Incremented by @ref osInterruptEnter and decremented by @ref osInterruptExit.
+ * Reschedules are deferred until it returns to zero.
+ */
+extern volatile osCounter_t 		interruptNesting;
+
+/**
+ * @brief The scheduler suspension nesting counter.
+ * @details Incremented by @ref osSchedulerSuspend and decremented by @ref osSchedulerResume.
+ * No context switch happens while it is not zero, but interrupts stay enabled.
+ */
+extern volatile osCounter_t 		schedulerSuspendNesting;
 
 /**
  * @brief The critical nesting counter.
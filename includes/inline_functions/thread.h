@@ -8,33 +8,254 @@
 #ifndef HBB04B7C2_6C51_466E_A8C0_054EFD919F41
 #define HBB04B7C2_6C51_466E_A8C0_054EFD919F41
 
+/**
+ * @brief Returns the bit of a priority in its ready bitmap word
+ * @param index the priority, or the index of the bitmap word
+ * @return the mask with only the bit of the priority set, counted from
+ * the most significant bit so that @ref OS_CLZ finds the highest priority
+ */
+#define READY_BITMAP_BIT(index) \
+	( (osCounter_t) 0x80000000UL >> ( (index) % READY_BITMAP_WORD_BITS ) )
+
+/**
+ * @brief Initializes the ready queue
+ * @note this function must be called before the first thread is readied
+ */
+OS_INLINE void
+thread_readyListInit( void )
+{
+	osCounter_t i;
+
+	for( i = 0; i < OS_PRIO_COUNT; i++ )
+		notPrioritizedList_init( &threads_ready.levels[i] );
+
+	for( i = 0; i < READY_BITMAP_WORDS; i++ )
+		threads_ready.bitmap[i] = 0;
+
+	threads_ready.group = 0;
+}
+
+/**
+ * @brief Checks if a thread is in the ready queue
+ * @param thread pointer to the thread control block
+ * @retval true if the thread is in the ready queue
+ * @retval false if the thread is not in the ready queue
+ */
+OS_INLINE osBool_t
+thread_isReady( Thread_t* thread )
+{
+	return thread->schedulerListItem.list == &threads_ready.levels[thread->priority];
+}
+
+/**
+ * @brief Returns the highest priority of all ready threads
+ * @return the highest (numerically smallest) priority in the ready queue
+ * @note this function must be used in a critical section. There is always
+ * at least one thread (the idle thread) in the ready queue.
+ */
+OS_INLINE osCounter_t
+thread_getHighestReadyPriority( void )
+{
+	osCounter_t word;
+
+	OS_ASSERT( threads_ready.group );
+
+	word = OS_CLZ( threads_ready.group );
+	return word * READY_BITMAP_WORD_BITS + OS_CLZ( threads_ready.bitmap[word] );
+}
+
+/**
+ * @brief Appends a thread to the ready list of its priority level
+ * @param thread pointer to the thread control block, the scheduler list
+ * item of which must not be in any list
+ * @note this function must be used in a critical section
+ */
+OS_INLINE void
+thread_readyInsert( Thread_t* thread )
+{
+	osCounter_t priority = thread->priority;
+#if OS_USE_EDF
+	NotPrioritizedList_t* level = &threads_ready.levels[priority];
+	NotPrioritizedListItem_t* i;
+	Thread_t* other;
+#endif
+
+	OS_ASSERT( priority < OS_PRIO_COUNT );
+
+#if OS_USE_EDF
+	/* the EDF level is sorted by absolute deadline, threads with the same deadline
+	 * are arranged in the order they are inserted. A thread without a deadline is
+	 * only there because it inherited the EDF priority through a mutex or a client,
+	 * it goes ahead of all the EDF threads, after the ones that inherited earlier */
+	if( (priority == OS_EDF_PRIORITY) && (level->first != NULL) )
+	{
+		i = level->first;
+
+		for( ; ; )
+		{
+			other = (Thread_t*) i->container;
+
+			/* insert just before the first EDF thread that runs later */
+			if( (other->period != 0) && ( (thread->period == 0) ||
+				!TIME_IS_REACHED( other->absoluteDeadline, thread->absoluteDeadline ) ) )
+			{
+				listItemCookie_insertBefore( &thread->schedulerListItem, i );
+
+				if( i == level->first )
+					level->first = &thread->schedulerListItem;
+				break;
+			}
+
+			i = i->next;
+
+			/* insert as last item */
+			if( i == level->first )
+			{
+				listItemCookie_insertBefore( &thread->schedulerListItem, i );
+				break;
+			}
+		}
+
+		thread->schedulerListItem.list = level;
+	}
+	else
+#endif
+	notPrioritizedList_insert( &thread->schedulerListItem, &threads_ready.levels[priority] );
+
+	threads_ready.bitmap[priority / READY_BITMAP_WORD_BITS] |= READY_BITMAP_BIT(priority);
+	threads_ready.group |= READY_BITMAP_BIT(priority / READY_BITMAP_WORD_BITS);
+}
+
+/**
+ * @brief Removes a thread from the ready queue
+ * @param thread pointer to the thread control block, which must be in
+ * the ready queue
+ * @note this function must be used in a critical section
+ */
+OS_INLINE void
+thread_readyRemove( Thread_t* thread )
+{
+	osCounter_t priority = thread->priority;
+
+	OS_ASSERT( thread_isReady(thread) );
+
+	list_remove( &thread->schedulerListItem );
+
+	/* clear the bits once the priority level becomes empty */
+	if( threads_ready.levels[priority].first == NULL )
+	{
+		threads_ready.bitmap[priority / READY_BITMAP_WORD_BITS] &= ~READY_BITMAP_BIT(priority);
+
+		if( threads_ready.bitmap[priority / READY_BITMAP_WORD_BITS] == 0 )
+			threads_ready.group &= ~READY_BITMAP_BIT(priority / READY_BITMAP_WORD_BITS);
+	}
+}
+
 /**
  * @brief Reschedules a thread
- * @details This function will check if the currentThread has the highest
- * priority in the ready list. If not, it will set nextThread to be the the
- * thread which has the highest priority in the ready list, so that it can
+ * @details This function will check if nextThread is still ready and has
+ * the highest priority in the ready queue. If not, it will set nextThread to
+ * be the first thread of the highest ready priority level, so that it can
  * be swapped into the CPU by the context switcher by calling @ref port_yield.
+ * nextThread is allowed to be a thread that has just left the ready queue,
+ * as long as its control block has not been freed.
+ *
+ * If current thread is still ready and has a preemption threshold above its
+ * priority, it keeps running unless a thread with a priority higher than the
+ * threshold is ready. Round-robin rotation does not apply to such a thread.
  * @note this function must be used in a critical section.
  */
 OS_INLINE void
 thread_setNew( void )
 {
+	NotPrioritizedList_t* level;
+	osCounter_t priority;
+
 	/* this function has to be called in a critical section because it accesses global resources. */
 	OS_ASSERT( criticalNesting );
 
-	/* the next thread pointer have to be in the ready list */
-	OS_ASSERT( (void*)nextThread->schedulerListItem.list == &threads_ready );
+	priority = thread_getHighestReadyPriority();
+	level = &threads_ready.levels[priority];
+
+	/* current thread is protected by its preemption threshold */
+	if( thread_isReady(currentThread) &&
+		(currentThread->preemptionThreshold < currentThread->priority) &&
+		(priority >= currentThread->preemptionThreshold) )
+		nextThread = currentThread;
 
-	/* check if next thread's priority is the highest */
-	if( nextThread->priority == threads_ready.first->value )
+	else
+#if OS_USE_EDF
+	/* the EDF level is sorted by absolute deadline, the earliest deadline always runs */
+	if( level == &threads_ready.levels[OS_EDF_PRIORITY] )
+		nextThread = (Thread_t*)( level->first->container );
+
+	else
+#endif
+	/* check if next thread is ready and its priority is the highest */
+	if( nextThread->schedulerListItem.list == level )
 	{
 		/* do nothing, nextThread will be loaded */
 	}
-	else /* next thread's priority is not the highest */
+	else /* next thread is not ready or its priority is not the highest */
 	{
-		/* load the first highest priority thread */
-		nextThread = (Thread_t*)( threads_ready.first->container );
+		/* load the first thread of the highest priority */
+		nextThread = (Thread_t*)( level->first->container );
 	}
 }
 
+/**
+ * @brief Checks if current thread should be preempted
+ * @retval true if the first thread of the highest ready priority should run instead
+ * of current thread
+ * @retval false if current thread should keep running
+ * @details This function is used after threads have been readied or priorities
+ * have been changed, to decide whether @ref thread_setNew and @ref port_yield
+ * need to be called. Only threads with a priority higher than the preemption
+ * threshold of current thread, or than its priority if it is higher (e.g.
+ * inherited), can preempt it. EDF threads are also preempted by EDF threads with
+ * an earlier deadline.
+ * @note this function must be used in a critical section.
+ */
+OS_INLINE osBool_t
+thread_isPreemptionNeeded( void )
+{
+	osCounter_t priority = thread_getHighestReadyPriority();
+	osCounter_t threshold = currentThread->preemptionThreshold;
+
+	if( currentThread->priority < threshold )
+		threshold = currentThread->priority;
+
+	if( priority < threshold )
+		return true;
+
+#if OS_USE_EDF
+	if( (priority == OS_EDF_PRIORITY) && (threshold == OS_EDF_PRIORITY) )
+		return (Thread_t*)( threads_ready.levels[priority].first->container ) != currentThread;
+#endif
+
+	return false;
+}
+
+/**
+ * @brief Requests a reschedule
+ * @details Wake-up paths call this function instead of calling @ref thread_setNew
+ * and @ref port_yield directly. The reschedule is performed only once, when the
+ * outermost critical section exits, or when the outermost interrupt handler exits
+ * if the handlers call @ref osInterruptEnter and @ref osInterruptExit. An interrupt
+ * handler that wakes several threads therefore yields only once.
+ * @note this function must be used in a critical section.
+ */
+OS_INLINE void
+thread_requestReschedule( void )
+{
+	OS_ASSERT( criticalNesting );
+
+	if( reschedulePending )
+		rescheduleMergedCounter++;
+	else
+		reschedulePending = true;
+
+	rescheduleRequestCounter++;
+}
+
 #endif /* HBB04B7C2_6C51_466E_A8C0_054EFD919F41 */
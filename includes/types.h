@@ -20,6 +20,16 @@ typedef struct notPrioritizedList 			NotPrioritizedList_t;		/**< @brief Typedef
  * @}
  */
 
+/** *************************************************************************
+ * @ingroup os_internal_wheel
+ * @{
+ */
+struct timingWheel;
+typedef struct timingWheel 					TimingWheel_t;	/**< @brief Typedef for @ref timingWheel */
+/**
+ * @}
+ */
+
 /** *************************************************************************
  * @ingroup os_heap
  * @{
@@ -36,7 +46,9 @@ typedef struct heap 						Heap_t;			/**< @brief Typedef for @ref heap */
 
 /* thread control block */
 struct thread;
+struct readyList;
 typedef struct thread 						Thread_t;
+typedef struct readyList 					ReadyList_t;
 
 /* signal related */
 struct signal;
@@ -45,9 +57,11 @@ typedef struct signal 						Signal_t;
 typedef struct signalWait 					SignalWait_t;
 
 /* mutex related */
+struct mutexBase;
 struct mutex;
 struct recursiveMutex;
 struct mutexWait;
+typedef struct mutexBase 					MutexBase_t;
 typedef struct mutex 						Mutex_t;
 typedef struct recursiveMutex 				RecursiveMutex_t;
 typedef struct mutexWait 					MutexWait_t;
@@ -66,6 +80,36 @@ typedef struct queue 						Queue_t;
 typedef struct queueWriteWait 				QueueWriteWait_t;
 typedef struct queueReadWait 				QueueReadWait_t;
 
+/* message queue related */
+struct messageQueue;
+typedef struct messageQueue 				MessageQueue_t;
+
+/* single-producer single-consumer ring related */
+struct spscRing;
+typedef struct spscRing 					SpscRing_t;
+
+/* multi-producer single-consumer ring related */
+struct mpscRing;
+typedef struct mpscRing 					MpscRing_t;
+
+/* stream buffer related */
+struct streamBuffer;
+typedef struct streamBuffer 				StreamBuffer_t;
+
+/* synchronous message passing related */
+struct msgChannel;
+struct msgSendWait;
+struct msgReceiveWait;
+typedef struct msgChannel 					MsgChannel_t;
+typedef struct msgSendWait 					MsgSendWait_t;
+typedef struct msgReceiveWait 				MsgReceiveWait_t;
+
+/* wait for multiple objects related */
+struct waitAnyItem;
+struct waitAnyWait;
+typedef struct waitAnyItem 					WaitAnyItem_t;
+typedef struct waitAnyWait 					WaitAnyWait_t;
+
 /* timer related */
 struct timer;
 struct timerPriority;
@@ -144,6 +188,19 @@ struct notPrioritizedList
 	NotPrioritizedListItem_t *volatile first;	/**< @brief points to the first item in the list */
 };
 
+/**
+ * @brief The timing wheel
+ * @details A hashed timing wheel holding prioritized list items whose value is
+ * an absolute wake up time. An item is put into the slot selected by the low
+ * bits of its wake up time, so inserting and removing are constant time. Items
+ * in a slot are not sorted, and may wake up in a later revolution of the wheel.
+ */
+struct timingWheel
+{
+	/** @brief the slots, item with wake up time t is in slot t % OS_TIMING_WHEEL_SIZE */
+	NotPrioritizedList_t slots[OS_TIMING_WHEEL_SIZE];
+};
+
 /**
  * @brief The memory block header
  * @details This structure is used in the heap and memory lists to manage
@@ -182,6 +239,50 @@ struct heap
 	MemoryBlock_t *volatile current;
 };
 
+/**
+ * @brief Number of bits in a word of the ready bitmap
+ */
+#define READY_BITMAP_WORD_BITS 		32
+
+/**
+ * @brief Number of words in the ready bitmap
+ */
+#define READY_BITMAP_WORDS 			( (OS_PRIO_COUNT + READY_BITMAP_WORD_BITS - 1) / READY_BITMAP_WORD_BITS )
+
+/* the group word has one bit for each bitmap word */
+#if OS_PRIO_COUNT > READY_BITMAP_WORD_BITS * READY_BITMAP_WORD_BITS
+#error "OS_PRIO_COUNT must not exceed READY_BITMAP_WORD_BITS * READY_BITMAP_WORD_BITS"
+#endif
+
+/**
+ * @brief Fails to compile unless a bitmap word is exactly an osCounter_t, which
+ * the bit positions and @ref OS_CLZ rely on
+ */
+typedef char ReadyBitmapWordCheck_t[ (sizeof(osCounter_t) * 8 == READY_BITMAP_WORD_BITS) ? 1 : -1 ];
+
+/**
+ * @brief The ready queue
+ * @details Ready threads are kept in one first-in-first-out list per
+ * priority level. A two-level bitmap records which levels are not empty,
+ * so that the highest ready priority can be found with two count leading
+ * zeros operations regardless of the number of ready threads.
+ *
+ * Priority p is recorded in bitmap word p / 32, at the bit counted from the
+ * most significant end by p % 32. Bit w of the group word, counted the same
+ * way, is set if bitmap word w is not zero.
+ */
+struct readyList
+{
+	/** @brief the ready threads, one list for each priority level */
+	NotPrioritizedList_t levels[OS_PRIO_COUNT];
+
+	/** @brief set bit for every non-zero word in @ref readyList.bitmap */
+	volatile osCounter_t group;
+
+	/** @brief set bit for every non-empty list in @ref readyList.levels */
+	volatile osCounter_t bitmap[READY_BITMAP_WORDS];
+};
+
 /**
  * @brief The thread control block
  */
@@ -200,9 +301,100 @@ struct thread
 	NotPrioritizedListItem_t schedulerListItem;
 	volatile osCounter_t priority;	/**< @brief the priority of the thread */
 
+	/**
+	 * @brief the preemption threshold of the thread
+	 * @details While the thread is running, only threads with a priority higher
+	 * than this value can preempt it. Equal to @ref thread.priority if the
+	 * threshold is not used.
+	 */
+	volatile osCounter_t preemptionThreshold;
+
+	/**
+	 * @brief the round-robin time slice in ticks, 0 if the thread is
+	 * never rotated by the tick handler
+	 */
+	volatile osCounter_t timeSlice;
+
+	/**
+	 * @brief ticks left in the current time slice
+	 * @details refilled from @ref thread.timeSlice when the slice is used up,
+	 * when the thread yields and when the thread is readied.
+	 */
+	volatile osCounter_t timeSliceLeft;
+
+	/**
+	 * @brief the number of time slices the thread has used up
+	 */
+	volatile osCounter_t timeSliceCounter;
+
+#if OS_USE_EDF
+	/**
+	 * @brief the relative deadline of an EDF thread in ticks, measured
+	 * from the start of each period
+	 */
+	volatile osCounter_t relativeDeadline;
+
+	/**
+	 * @brief the period of an EDF thread in ticks, 0 if the thread is
+	 * not an EDF thread
+	 */
+	volatile osCounter_t period;
+
+	/**
+	 * @brief start of the current period, the lower word of the system time
+	 */
+	volatile osCounter_t release;
+
+	/**
+	 * @brief the absolute deadline of the current period, the lower word of
+	 * the system time
+	 * @details the ready threads at @ref OS_EDF_PRIORITY are sorted by this value.
+	 */
+	volatile osCounter_t absoluteDeadline;
+
+	/**
+	 * @brief the number of periods that completed after their deadline
+	 */
+	volatile osCounter_t deadlineMissCounter;
+#endif
+
+#if OS_USE_CPU_BUDGET
+	/**
+	 * @brief the CPU budget in ticks per replenishment period, 0 if the
+	 * thread has no budget
+	 */
+	volatile osCounter_t budget;
+
+	volatile osCounter_t budgetPeriod;		/**< @brief the replenishment period in ticks */
+	volatile osCounter_t budgetLeft;		/**< @brief ticks left in the budget */
+
+	/**
+	 * @brief the priority of the thread while it has budget left
+	 * @details @ref thread.priority equals this value unless the budget is used up.
+	 */
+	volatile osCounter_t budgetPriority;
+
+	/**
+	 * @brief the priority of the thread while its budget is used up
+	 */
+	volatile osCounter_t backgroundPriority;
+
+	/**
+	 * @brief the number of times the thread used up its budget
+	 */
+	volatile osCounter_t budgetOverrunCounter;
+
+	/**
+	 * @brief the budget list item
+	 * @details Inserted into the budget timing wheel @ref budgets_timed with the time
+	 * of the next replenishment, once the thread starts to consume a full budget.
+	 */
+	PrioritizedListItem_t budgetListItem;
+#endif
+
 	/**
 	 * @brief the timer list item
-	 * @details This item will be inserted into the system timing list @ref threads_timed
+	 * @details This item will be inserted into the system timing wheel @ref threads_timed
 	 * when the thread is blocked and has a finite timeout.
 	 */
 	PrioritizedListItem_t timerListItem;
@@ -221,6 +413,40 @@ struct thread
 	 */
 	MemoryList_t localMemory;
 
+	/**
+	 * @brief the priority assigned to the thread
+	 * @details @ref thread.priority is higher than this value while the thread
+	 * inherits the priority of a thread waiting for one of its mutexes.
+	 */
+	volatile osCounter_t basePriority;
+
+	/**
+	 * @brief list of the mutexes owned by the thread
+	 */
+	NotPrioritizedList_t heldMutexes;
+
+	/**
+	 * @brief the mutex the thread is blocked on, NULL if none
+	 */
+	MutexBase_t *volatile blockingMutex;
+
+	/**
+	 * @brief list of the threads waiting for a reply to a message received by
+	 * the thread, see @ref osMsgReceive
+	 */
+	PrioritizedList_t replyingThreads;
+
+	/**
+	 * @brief the thread whose reply the thread is blocked for, NULL if none
+	 */
+	Thread_t *volatile blockingServer;
+
+	/**
+	 * @brief the wait struct of @ref osWaitAny while the thread waits for
+	 * several objects, NULL otherwise
+	 */
+	WaitAnyWait_t *volatile waitAny;
+
 	/**
 	 * @brief docking position for the wait struct
 	 * @details Before the thread blocks, a wait struct (defined on the thread's stack)
@@ -247,6 +473,13 @@ struct signal
 	 * thread control block.
 	 */
 	PrioritizedList_t threadsOnSignal;
+
+	/**
+	 * @brief list of the threads waiting for the signal among other objects,
+	 * see @ref osWaitAny
+	 * @details not sorted, all of them are readied at once
+	 */
+	NotPrioritizedList_t selectors;
 };
 
 /**
@@ -275,41 +508,65 @@ struct signalWait
 };
 
 /**
- * @brief the mutex control block
+ * @brief the part shared by the mutex and the recursive mutex control blocks
+ * @details The owner is recorded so that it can inherit the priority of the
+ * threads blocked for the mutex.
  */
-struct mutex
+struct mutexBase
 {
 	/**
-	 * @brief list of threads blocked for the mutex
+	 * @brief list of all threads blocked for the mutex
 	 */
 	PrioritizedList_t threads;
 
 	/**
-	 * @brief the state of the mutex
-	 * @details set to true if the mutex is locked
+	 * @brief list of the threads waiting for the mutex to be unlocked among
+	 * other objects, see @ref osWaitAny
+	 * @details not sorted, all of them are readied at once
 	 */
-	osBool_t volatile locked;
-};
+	NotPrioritizedList_t selectors;
 
-/**
- * @brief the recursive mutex control block
- */
-struct recursiveMutex
-{
 	/**
-	 * @brief list of all threads blocked for the recursive mutex
+	 * @brief owner of the mutex, NULL if the mutex is unlocked
+	 * @details Set and cleared atomically by the fast paths if
+	 * @ref OS_USE_ATOMICS is enabled.
 	 */
-	PrioritizedList_t threads;
+	Thread_t* volatile owner;
 
 	/**
-	 * @brief owner of the mutex, NULL if none
+	 * @brief the list item in @ref thread.heldMutexes of the owner
+	 * @details A mutex locked by the atomic fast path is only inserted into the
+	 * list once another thread has to wait for it, see @ref mutex_register.
 	 */
-	Thread_t* volatile owner;
+	NotPrioritizedListItem_t heldListItem;
 
 	/**
-	 * @brief recursive counter for locking and unlocking
+	 * @brief recursive counter for locking and unlocking, never greater than
+	 * 1 for a mutex that is not recursive
 	 */
 	volatile osCounter_t counter;
+
+	/**
+	 * @brief the priority ceiling, @ref MUTEX_NO_CEILING if none
+	 * @details The owner runs at least at this priority.
+	 */
+	osCounter_t ceiling;
+};
+
+/**
+ * @brief the mutex control block
+ */
+struct mutex
+{
+	MutexBase_t base;	/**< @brief the owner and the waiting threads */
+};
+
+/**
+ * @brief the recursive mutex control block
+ */
+struct recursiveMutex
+{
+	MutexBase_t base;	/**< @brief the owner, the waiting threads and the recursive counter */
 };
 
 /**
@@ -335,8 +592,17 @@ struct semaphore
 	 */
 	PrioritizedList_t threads;
 
+	/**
+	 * @brief list of the threads waiting for the semaphore among other objects,
+	 * see @ref osWaitAny
+	 * @details not sorted, all of them are readied at once
+	 */
+	NotPrioritizedList_t selectors;
+
 	/**
 	 * @brief the semaphore counter
+	 * @details If @ref OS_USE_ATOMICS is enabled, this is updated atomically by
+	 * the fast paths, and set to a reserved value while threads may be waiting.
 	 */
 	volatile osCounter_t counter;
 };
@@ -368,6 +634,13 @@ struct queue
 	 */
 	PrioritizedList_t writingThreads;
 
+	/**
+	 * @brief list of the threads waiting for data among other objects,
+	 * see @ref osWaitAny
+	 * @details not sorted, all of them are readied at once
+	 */
+	NotPrioritizedList_t selectors;
+
 	/**
 	 * @brief the queue internal memory
 	 */
@@ -388,6 +661,20 @@ struct queue
 	 * @brief the counter marking the current write position
 	 */
 	volatile osCounter_t write;
+
+	/**
+	 * @brief number of bytes reserved by @ref osQueueSendReserve at the write
+	 * position, 0 if none
+	 * @details no other data can be written to the queue until it is committed
+	 */
+	volatile osCounter_t reserved;
+
+	/**
+	 * @brief number of bytes acquired by @ref osQueueReceiveAcquire at the read
+	 * position, 0 if none
+	 * @details no other data can be read from the queue until it is released
+	 */
+	volatile osCounter_t acquired;
 };
 
 /**
@@ -440,6 +727,300 @@ struct queueWriteWait
 	const void *data;
 };
 
+/**
+ * @brief the message queue control block
+ * @details Threads blocked on a message queue dock
+ * @ref QueueReadWait_t and @ref QueueWriteWait_t, the same as for a queue.
+ */
+struct messageQueue
+{
+	/**
+	 * @brief list of all threads waiting to read from the message queue
+	 */
+	PrioritizedList_t readingThreads;
+
+	/**
+	 * @brief list of all threads waiting to write to the message queue
+	 */
+	PrioritizedList_t writingThreads;
+
+	/**
+	 * @brief list of the threads waiting for the message queue among other
+	 * objects, see @ref osWaitAny
+	 * @details not sorted, all of them are readied at once
+	 */
+	NotPrioritizedList_t selectors;
+
+	/**
+	 * @brief the memory of the slots
+	 */
+	osByte_t *memory;
+
+	/**
+	 * @brief size of a message in bytes
+	 */
+	osCounter_t itemSize;
+
+	/**
+	 * @brief distance between two slots in bytes, the item size rounded up by
+	 * @ref ITEM_ROUND_UP_SIZE
+	 */
+	osCounter_t stride;
+
+	/**
+	 * @brief size of the memory of the slots in bytes
+	 */
+	osCounter_t size;
+
+	/**
+	 * @brief number of messages in the message queue
+	 */
+	volatile osCounter_t count;
+
+	/**
+	 * @brief number of slots
+	 */
+	osCounter_t itemCount;
+
+	/**
+	 * @brief offset of the slot of the next message to be read
+	 */
+	volatile osCounter_t read;
+
+	/**
+	 * @brief offset of the slot of the next message to be written
+	 */
+	volatile osCounter_t write;
+};
+
+/**
+ * @brief the single-producer single-consumer ring control block
+ * @details The producer only writes @ref write and the consumer only writes
+ * @ref read, so neither side needs a critical section to move data. The
+ * consumer blocking for data docks a @ref SemaphoreWait_t.
+ */
+struct spscRing
+{
+	/**
+	 * @brief list of the consumer thread while it waits for data, at most one
+	 * @details the producer only enters a critical section when it is not empty
+	 */
+	PrioritizedList_t readingThreads;
+
+	/**
+	 * @brief the ring memory
+	 */
+	osByte_t *memory;
+
+	/**
+	 * @brief size of the ring memory, one byte more than the capacity
+	 */
+	osCounter_t size;
+
+	/**
+	 * @brief position of the next byte to be read, written by the consumer only
+	 */
+	volatile osCounter_t read;
+
+	/**
+	 * @brief position of the next byte to be written, written by the producer only
+	 */
+	volatile osCounter_t write;
+};
+
+/**
+ * @brief the multi-producer single-consumer ring control block
+ * @details Producers claim a slot by advancing @ref head, fill it outside of
+ * any critical section and publish it by setting its commit flag. The consumer
+ * takes the slots in claim order and blocks, docking a @ref SemaphoreWait_t,
+ * while the next slot is not committed.
+ */
+struct mpscRing
+{
+	/**
+	 * @brief list of the consumer thread while it waits for a slot, at most one
+	 */
+	PrioritizedList_t readingThreads;
+
+	/**
+	 * @brief the memory of the slots
+	 */
+	osByte_t *memory;
+
+	/**
+	 * @brief the commit flag of each slot, non-zero once the slot is filled
+	 */
+	volatile osByte_t *committed;
+
+	/**
+	 * @brief size of an item in bytes
+	 */
+	osCounter_t itemSize;
+
+	/**
+	 * @brief distance between two slots in bytes, the item size rounded up by
+	 * @ref ITEM_ROUND_UP_SIZE
+	 */
+	osCounter_t stride;
+
+	/**
+	 * @brief number of slots, a power of two
+	 */
+	osCounter_t itemCount;
+
+	/**
+	 * @brief number of slots ever claimed by the producers, wraps around
+	 */
+	volatile osCounter_t head;
+
+	/**
+	 * @brief number of slots ever taken by the consumer, wraps around
+	 */
+	volatile osCounter_t tail;
+};
+
+/**
+ * @brief the stream buffer control block
+ * @details The data is kept in a queue. Readers block in its list of reading
+ * threads docking @ref QueueReadWait_t, whose size is set to the number of bytes
+ * actually received before they are readied, or to 0 if the stream buffer is
+ * deleted.
+ */
+struct streamBuffer
+{
+	/**
+	 * @brief the queue holding the data
+	 */
+	Queue_t *queue;
+
+	/**
+	 * @brief number of bytes in the stream buffer at which a blocked reader
+	 * is readied
+	 */
+	volatile osCounter_t triggerLevel;
+};
+
+/**
+ * @brief the synchronous message channel control block
+ * @details A client sending a message is blocked in @ref sendingThreads until
+ * a server receives it, and then in @ref thread.replyingThreads of the server
+ * until the server replies.
+ */
+struct msgChannel
+{
+	/**
+	 * @brief list of the clients whose messages are not received yet
+	 */
+	PrioritizedList_t sendingThreads;
+
+	/**
+	 * @brief list of the servers waiting for a message
+	 */
+	PrioritizedList_t receivingThreads;
+};
+
+/**
+ * @brief the send docking struct for synchronous messages
+ */
+struct msgSendWait
+{
+	/**
+	 * @brief the wait result
+	 * @details set to false before entering blocking state,
+	 * set to true once the reply is copied.
+	 */
+	volatile osBool_t result;
+
+	/**
+	 * @brief pointer to the request
+	 */
+	const void *request;
+
+	/**
+	 * @brief size of the request in bytes
+	 */
+	osCounter_t requestSize;
+
+	/**
+	 * @brief pointer to the buffer for the reply
+	 */
+	void *reply;
+
+	/**
+	 * @brief size of the reply buffer, set to the size of the reply when it
+	 * is copied
+	 */
+	osCounter_t replySize;
+};
+
+/**
+ * @brief the receive docking struct for synchronous messages
+ */
+struct msgReceiveWait
+{
+	/**
+	 * @brief the wait result
+	 * @details set to false before entering blocking state,
+	 * set to true once a request is copied.
+	 */
+	volatile osBool_t result;
+
+	/**
+	 * @brief pointer to the buffer for the request
+	 */
+	void *data;
+
+	/**
+	 * @brief size of the request buffer, set to the size of the request when it
+	 * is copied
+	 */
+	osCounter_t size;
+
+	/**
+	 * @brief the client whose request was copied
+	 */
+	Thread_t *client;
+};
+
+/**
+ * @brief the list item of a thread in the list of one of the objects it waits for
+ * in @ref osWaitAny
+ */
+struct waitAnyItem
+{
+	/**
+	 * @brief the list item, its container is the waiting thread
+	 */
+	NotPrioritizedListItem_t listItem;
+
+	/**
+	 * @brief the index of the object in the array passed to @ref osWaitAny
+	 */
+	osCounter_t index;
+};
+
+/**
+ * @brief the docking struct for waiting for several objects
+ */
+struct waitAnyWait
+{
+	/**
+	 * @brief the index of the object that became ready
+	 * @details set to @ref OS_WAIT_ANY_NONE before entering blocking state
+	 */
+	volatile osCounter_t index;
+
+	/**
+	 * @brief the list items, one per object
+	 */
+	WaitAnyItem_t *items;
+
+	/**
+	 * @brief the number of objects
+	 */
+	osCounter_t count;
+};
+
 /**
  * @brief the timer callback function type
  */
@@ -451,8 +1032,9 @@ typedef void (*TimerCallback_t)( void* argument );
 struct timer
 {
 	/**
-	 * @brief timer list item, to be put into the timer
-	 * list of the corresponding timer priority control block
+	 * @brief timer list item, to be put into the system timer wheel
+	 * @ref timers_timed while the timer is running, or into the expired or
+	 * inactive list of the corresponding timer priority control block
 	 * @details used in conjunction with future time to form
 	 * a single prioritized list item
 	 */
@@ -505,9 +1087,16 @@ struct timerPriorityBlock
 	Thread_t* volatile daemon;
 
 	/**
-	 * @brief the list for all active timers of the priority
+	 * @brief the list for the expired timers of the priority, whose
+	 * callback functions are waiting to be called by the daemon
+	 */
+	NotPrioritizedList_t timerExpiredList;
+
+	/**
+	 * @brief number of timers of the priority that are either in the
+	 * system timer wheel or in the expired list
 	 */
-	PrioritizedList_t timerActiveList;
+	volatile osCounter_t activeCounter;
 
 	/**
 	 * @brief the list for all inactive timers of the priority
@@ -16,6 +16,14 @@
  * @brief API Types
  */
 
+/**
+ * @brief System time type
+ * @ingroup os_api_types
+ * @details This type holds the system time in ticks. It is at least 64 bits
+ * wide, so that it does not overflow during the life time of a device.
+ */
+typedef unsigned long long osTime_t;
+
 /**
  * @brief Thread state type
  * @ingroup os_api_types
@@ -37,4 +45,48 @@ typedef enum {
 	OSTIMERMODE_PERIODIC		/**< @brief Periodic mode */
 } osTimerMode_t;
 
+/**
+ * @brief Queue region type
+ * @ingroup os_api_types
+ * @details This type describes a region of the memory of a queue handed out by
+ * @ref osQueueSendReserve or @ref osQueueReceiveAcquire. The region wraps around
+ * the end of the queue memory if secondSize is not 0.
+ */
+typedef struct {
+	void *first;				/**< @brief Start of the region */
+	osCounter_t firstSize;		/**< @brief Size of the region at first, in bytes */
+	void *second;				/**< @brief Start of the queue memory, where the region continues */
+	osCounter_t secondSize;		/**< @brief Size of the region at second, in bytes */
+} osQueueRegion_t;
+
+/**
+ * @brief Object type
+ * @ingroup os_api_types
+ * @details This type defines the types of the objects @ref osWaitAny can wait for.
+ */
+typedef enum {
+	OSOBJECT_QUEUE = 0,			/**< @brief Queue, ready when it holds data */
+	OSOBJECT_SEMAPHORE,			/**< @brief Semaphore, ready when its counter is not 0 */
+	OSOBJECT_MUTEX,				/**< @brief Mutex, ready when it is unlocked */
+	OSOBJECT_RECURSIVE_MUTEX,	/**< @brief Recursive mutex, ready when it is unlocked or owned by the caller */
+	OSOBJECT_SIGNAL,			/**< @brief Signal, ready when a signal value is sent onto it */
+	OSOBJECT_MESSAGE_QUEUE		/**< @brief Message queue, ready when it holds a message */
+} osObjectType_t;
+
+/**
+ * @brief Wait object type
+ * @ingroup os_api_types
+ * @details This type describes one of the objects passed to @ref osWaitAny.
+ */
+typedef struct {
+	osHandle_t handle;			/**< @brief Handle to the object */
+	osObjectType_t type;		/**< @brief Type of the object */
+} osWaitObject_t;
+
+/**
+ * @brief Returned by @ref osWaitAny if none of the objects became ready
+ * @ingroup os_api_types
+ */
+#define OS_WAIT_ANY_NONE 		( (osCounter_t) -1 )
+
 #endif /* H16488323_48F4_461D_8B3F_D30921D74E5A */
@@ -11,14 +11,25 @@
 Heap_t heap;
 MemoryList_t kernelMemoryList;
 
-PrioritizedList_t threads_timed;
-PrioritizedList_t threads_ready;
+TimingWheel_t threads_timed;
+TimingWheel_t timers_timed;
+#if OS_USE_CPU_BUDGET
+TimingWheel_t budgets_timed;
+#endif
+ReadyList_t threads_ready;
 
 Thread_t *volatile currentThread;
 Thread_t *volatile nextThread;
 
-volatile osCounter_t systemTime;
+volatile osTime_t systemTime;
+volatile osCounter_t systemTimeSequence;
 volatile osCounter_t criticalNesting;
+volatile osCounter_t interruptNesting;
+volatile osCounter_t schedulerSuspendNesting;
+
+volatile osBool_t reschedulePending;
+volatile osCounter_t rescheduleRequestCounter;
+volatile osCounter_t rescheduleMergedCounter;
 
 Thread_t idleThread;
 NotPrioritizedList_t timerPriorityList;
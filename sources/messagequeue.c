@@ -0,0 +1,429 @@
+/** **************************************************************
+ * @file
+ * @brief Message queue implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of the message queue.
+ * Unlike a queue, which is a stream of bytes, a message queue holds
+ * a fixed number of messages of the same size, so that a message is
+ * always sent and received as a whole.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+#include <string.h>
+
+/**
+ * @brief Writes a message to the next free slot of the message queue
+ * @param queue pointer to the message queue, which must not be full
+ * @param data pointer to the message to be written
+ */
+void
+messageQueue_write( MessageQueue_t* queue, const void* data )
+{
+	OS_ASSERT( queue->count < queue->itemCount );
+
+	memcpy( &queue->memory[queue->write], data, queue->itemSize );
+
+	queue->write += queue->stride;
+	if( queue->write == queue->size )
+		queue->write = 0;
+
+	queue->count++;
+}
+
+/**
+ * @brief Reads the oldest message from the message queue
+ * @param queue pointer to the message queue, which must not be empty
+ * @param data pointer to the buffer the message to be put in
+ */
+void
+messageQueue_read( MessageQueue_t* queue, void* data )
+{
+	OS_ASSERT( queue->count != 0 );
+
+	memcpy( data, &queue->memory[queue->read], queue->itemSize );
+
+	queue->read += queue->stride;
+	if( queue->read == queue->size )
+		queue->read = 0;
+
+	queue->count--;
+}
+
+/**
+ * @brief Serves the threads blocked on a message queue until no
+ * more operations can be performed
+ * @param queue pointer to the message queue
+ * @details Writers are only blocked while the message queue is full and
+ * readers only while it is empty, so whether the first waiter can be served
+ * is decided by the message count alone. The messages left afterwards ready
+ * the threads waiting for the message queue in @ref osWaitAny.
+ */
+void
+messageQueue_solveEquation( MessageQueue_t* queue )
+{
+	Thread_t* thread;
+	QueueReadWait_t* readWait;
+	QueueWriteWait_t* writeWait;
+
+	for( ; ; )
+	{
+		if( (queue->writingThreads.first != NULL) && (queue->count < queue->itemCount) )
+		{
+			thread = (Thread_t*)( queue->writingThreads.first->container );
+			writeWait = (QueueWriteWait_t*) thread->wait;
+
+			messageQueue_write( queue, writeWait->data );
+			writeWait->result = true;
+			thread_makeReady( thread );
+		}
+		else if( (queue->readingThreads.first != NULL) && (queue->count != 0) )
+		{
+			thread = (Thread_t*)( queue->readingThreads.first->container );
+			readWait = (QueueReadWait_t*) thread->wait;
+
+			messageQueue_read( queue, readWait->data );
+			readWait->result = true;
+			thread_makeReady( thread );
+		}
+		else
+			break;
+	}
+
+	/* messages left after serving the blocked readers */
+	if( queue->count != 0 )
+		waitAny_notify( &queue->selectors );
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+
+/**
+ * @brief Creates a message queue
+ * @param itemSize size of a message in bytes
+ * @param itemCount maximum number of messages in the message queue
+ * @return handle to the message queue, if the message queue is created
+ * successfully; 0, if the creation failed.
+ * @details Each slot is rounded up to a whole number of words, so that messages
+ * keep their natural alignment without being padded to the heap alignment.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osMessageQueueCreate( osCounter_t itemSize, osCounter_t itemCount )
+{
+	MessageQueue_t* queue;
+	osByte_t* memory;
+	osCounter_t stride;
+
+	OS_ASSERT( itemSize >= 1 );
+	OS_ASSERT( itemCount >= 1 );
+
+	stride = ITEM_ROUND_UP_SIZE( itemSize );
+
+	osThreadEnterCritical();
+	queue = memory_allocateFromHeap( sizeof(MessageQueue_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( queue == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	osThreadEnterCritical();
+	memory = memory_allocateFromHeap( stride * itemCount, &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( memory == NULL )
+	{
+		osThreadEnterCritical();
+		memory_returnToHeap( queue, & kernelMemoryList );
+		osThreadExitCritical();
+
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	queue->memory = memory;
+	queue->itemSize = itemSize;
+	queue->stride = stride;
+	queue->itemCount = itemCount;
+	queue->size = stride * itemCount;
+	queue->count = 0;
+	queue->read = 0;
+	queue->write = 0;
+
+	prioritizedList_init( &queue->readingThreads );
+	prioritizedList_init( &queue->writingThreads );
+	notPrioritizedList_init( &queue->selectors );
+
+	return (osHandle_t) queue;
+}
+
+/**
+ * @brief Deletes a message queue
+ * @param h handle to the message queue to be deleted
+ * @details This function deletes a message queue and releases the resources
+ * occupied by the slots and the control structures. The threads blocked on the
+ * message queue prior to its deletion will be readied and the block will fail.
+ * The handle should not be used again after calling this function.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osMessageQueueDelete( osHandle_t h )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		thread_makeAllReady( &queue->readingThreads );
+		thread_makeAllReady( &queue->writingThreads );
+		waitAny_notify( &queue->selectors );
+
+		memory_returnToHeap( queue->memory, & kernelMemoryList );
+		memory_returnToHeap( queue, & kernelMemoryList );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Resets the message queue to the initial state
+ * @param h handle to the message queue to be reset
+ * @details This function discards all the messages in the message queue.
+ * Threads blocked for writing are served afterwards.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osMessageQueueReset( osHandle_t h )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		queue->count = 0;
+		queue->read = 0;
+		queue->write = 0;
+		messageQueue_solveEquation( queue );
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Gets the number of messages in the message queue
+ * @param h handle to the message queue
+ * @return the number of messages in the message queue
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osMessageQueueGetCount( osHandle_t h )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osCounter_t result;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	result = queue->count;
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Gets the number of free slots in the message queue
+ * @param h handle to the message queue
+ * @return the number of messages that can be sent without blocking
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osMessageQueueGetFreeCount( osHandle_t h )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osCounter_t result;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	result = queue->itemCount - queue->count;
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Sends a message onto the message queue without blocking
+ * @param h handle to the message queue the message to be sent to
+ * @param data pointer to the message, of the item size of the message queue
+ * @retval true if the message was sent onto the message queue successfully
+ * @retval false if the message queue is full
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMessageQueueSendNonBlock( osHandle_t h, const void* data )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osBool_t result = false;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		if( queue->count < queue->itemCount )
+		{
+			result = true;
+			messageQueue_write( queue, data );
+			messageQueue_solveEquation( queue );
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Sends a message onto the message queue
+ * @param h handle to the message queue the message to be sent to
+ * @param data pointer to the message, of the item size of the message queue
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @retval true if the message was sent onto the message queue successfully
+ * @retval false if the message was not sent onto the message queue
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMessageQueueSend( osHandle_t h, const void* data, osCounter_t timeout )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osBool_t result = false;
+	QueueWriteWait_t writeWait;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		if( queue->count < queue->itemCount )
+		{
+			result = true;
+			messageQueue_write( queue, data );
+			messageQueue_solveEquation( queue );
+		}
+		else
+		{
+			writeWait.data = data;
+			writeWait.result = false;
+			writeWait.size = queue->itemSize;
+			thread_blockCurrent( &queue->writingThreads, timeout, &writeWait );
+			result = writeWait.result;
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Receives a message from the message queue without blocking
+ * @param h handle to the message queue the message to be received from
+ * @param data pointer to the buffer to hold the message, of the item size of
+ * the message queue
+ * @retval true if a message was received from the message queue successfully
+ * @retval false if the message queue is empty
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMessageQueueReceiveNonBlock( osHandle_t h, void* data )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osBool_t result = false;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		if( queue->count != 0 )
+		{
+			result = true;
+			messageQueue_read( queue, data );
+			messageQueue_solveEquation( queue );
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Receives a message from the message queue
+ * @param h handle to the message queue the message to be received from
+ * @param data pointer to the buffer to hold the message, of the item size of
+ * the message queue
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @retval true if a message was received from the message queue successfully
+ * @retval false if no message was received
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMessageQueueReceive( osHandle_t h, void* data, osCounter_t timeout )
+{
+	MessageQueue_t* queue = (MessageQueue_t*) h;
+	osBool_t result = false;
+	QueueReadWait_t readWait;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		if( queue->count != 0 )
+		{
+			result = true;
+			messageQueue_read( queue, data );
+			messageQueue_solveEquation( queue );
+		}
+		else
+		{
+			readWait.data = data;
+			readWait.result = false;
+			readWait.size = queue->itemSize;
+			thread_blockCurrent( &queue->readingThreads, timeout, &readWait );
+			result = readWait.result;
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
@@ -0,0 +1,311 @@
+/** **************************************************************
+ * @file
+ * @brief Multi-producer single-consumer ring implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of the multi-producer
+ * single-consumer ring. Several interrupts, possibly nesting, and threads
+ * pass items of a fixed size to one consumer thread. A producer claims a
+ * slot, fills it with interrupts enabled and then commits it, the consumer
+ * takes the slots in the order they were claimed.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+#include <string.h>
+
+/**
+ * @brief Claims the next free slot of a ring for a producer
+ * @param ring pointer to the ring
+ * @param slot pointer to where the index of the claimed slot is put
+ * @retval true if a slot was claimed
+ * @retval false if the ring is full
+ * @details With @ref OS_USE_ATOMICS the claim is a compare-and-swap on the head,
+ * retried if another producer claimed a slot in the meantime. Otherwise interrupts
+ * are masked for the claim only, never for the copy.
+ */
+osBool_t
+mpscRing_claim( MpscRing_t* ring, osCounter_t* slot )
+{
+	osCounter_t head;
+
+#if OS_USE_ATOMICS
+	for( ; ; )
+	{
+		head = ring->head;
+
+		if( head - ring->tail >= ring->itemCount )
+			return false;
+
+		if( OS_ATOMIC_CAS( &ring->head, head, head + 1 ) )
+			break;
+	}
+#else
+	osBool_t result = false;
+
+	osThreadEnterCritical();
+	{
+		head = ring->head;
+
+		if( head - ring->tail < ring->itemCount )
+		{
+			ring->head = head + 1;
+			result = true;
+		}
+	}
+	osThreadExitCritical();
+
+	if( result == false )
+		return false;
+#endif
+
+	*slot = head & ( ring->itemCount - 1 );
+	return true;
+}
+
+/**
+ * @brief Readies the consumer blocked on a ring
+ * @param ring pointer to the ring
+ */
+void
+mpscRing_wakeConsumer( MpscRing_t* ring )
+{
+	Thread_t* thread;
+	SemaphoreWait_t* wait;
+
+	osThreadEnterCritical();
+	{
+		/* another producer or a timeout might have readied it in the meantime */
+		if( ring->readingThreads.first != NULL )
+		{
+			thread = (Thread_t*)( ring->readingThreads.first->container );
+			wait = (SemaphoreWait_t*) thread->wait;
+
+			wait->result = true;
+			thread_makeReady( thread );
+
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
+		}
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Creates a multi-producer single-consumer ring
+ * @param itemSize size of an item in bytes
+ * @param itemCount number of slots, must be a power of two
+ * @return handle to the ring, if the ring is created successfully;
+ * 0, if the creation failed.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osMpscRingCreate( osCounter_t itemSize, osCounter_t itemCount )
+{
+	MpscRing_t* ring;
+	osByte_t* memory;
+	osCounter_t stride;
+
+	OS_ASSERT( itemSize >= 1 );
+	OS_ASSERT( (itemCount >= 1) && ( (itemCount & (itemCount - 1)) == 0 ) );
+
+	stride = ITEM_ROUND_UP_SIZE( itemSize );
+
+	osThreadEnterCritical();
+	ring = memory_allocateFromHeap( sizeof(MpscRing_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( ring == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	osThreadEnterCritical();
+	/* the slots followed by their commit flags */
+	memory = memory_allocateFromHeap( stride * itemCount + itemCount, &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( memory == NULL )
+	{
+		osThreadEnterCritical();
+		memory_returnToHeap( ring, & kernelMemoryList );
+		osThreadExitCritical();
+
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	ring->memory = memory;
+	ring->committed = memory + stride * itemCount;
+	ring->itemSize = itemSize;
+	ring->stride = stride;
+	ring->itemCount = itemCount;
+	ring->head = 0;
+	ring->tail = 0;
+
+	memset( (osByte_t*) ring->committed, 0, itemCount );
+	prioritizedList_init( &ring->readingThreads );
+
+	return (osHandle_t) ring;
+}
+
+/**
+ * @brief Deletes a multi-producer single-consumer ring
+ * @param h handle to the ring to be deleted
+ * @details The consumer blocked on the ring prior to its deletion will be
+ * readied and the receive will fail. No producer may be between claiming and
+ * committing a slot. The handle should not be used again after calling this
+ * function.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osMpscRingDelete( osHandle_t h )
+{
+	MpscRing_t* ring = (MpscRing_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		thread_makeAllReady( &ring->readingThreads );
+
+		memory_returnToHeap( ring->memory, & kernelMemoryList );
+		memory_returnToHeap( ring, & kernelMemoryList );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Writes an item into the ring
+ * @param h handle to the ring
+ * @param data pointer to the item, of the item size of the ring
+ * @retval true if the item was written
+ * @retval false if the ring is full
+ * @details The item is copied with interrupts enabled, so a producer can be
+ * interrupted by another producer of the same ring at any point. The kernel is
+ * only entered if the consumer is blocked on the ring, which wakes it once for
+ * all the items written until it runs.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMpscRingWrite( osHandle_t h, const void* data )
+{
+	MpscRing_t* ring = (MpscRing_t*) h;
+	osCounter_t slot;
+
+	OS_ASSERT(h);
+
+	if( mpscRing_claim( ring, &slot ) == false )
+		return false;
+
+	memcpy( &ring->memory[slot * ring->stride], data, ring->itemSize );
+
+	/* the item has to be filled before it is published (release) */
+	OS_MEMORY_BARRIER();
+	ring->committed[slot] = 1;
+
+	/* the commit flag has to be visible before the consumer is checked */
+	OS_MEMORY_BARRIER();
+
+	if( ring->readingThreads.first != NULL )
+		mpscRing_wakeConsumer( ring );
+
+	return true;
+}
+
+/**
+ * @brief Reads the oldest item from the ring without blocking
+ * @param h handle to the ring
+ * @param data pointer to the buffer to hold the item, of the item size of the ring
+ * @retval true if an item was read
+ * @retval false if the ring is empty, or the oldest slot is claimed but not yet
+ * committed
+ * @details It must only be called by the single consumer of the ring.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMpscRingRead( osHandle_t h, void* data )
+{
+	MpscRing_t* ring = (MpscRing_t*) h;
+	osCounter_t tail, slot;
+
+	OS_ASSERT(h);
+
+	tail = ring->tail;
+	slot = tail & ( ring->itemCount - 1 );
+
+	if( ring->committed[slot] == 0 )
+		return false;
+
+	/* the item is only read after its commit flag (acquire) */
+	OS_MEMORY_BARRIER();
+
+	memcpy( data, &ring->memory[slot * ring->stride], ring->itemSize );
+	ring->committed[slot] = 0;
+
+	/* the slot has to be emptied before it can be claimed again (release) */
+	OS_MEMORY_BARRIER();
+	ring->tail = tail + 1;
+
+	return true;
+}
+
+/**
+ * @brief Reads the oldest item from the ring, blocking while there is none
+ * @param h handle to the ring
+ * @param data pointer to the buffer to hold the item, of the item size of the ring
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @retval true if an item was read
+ * @retval false if the wait timed out
+ * @details It must only be called by the single consumer of the ring.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMpscRingReceive( osHandle_t h, void* data, osCounter_t timeout )
+{
+	MpscRing_t* ring = (MpscRing_t*) h;
+	SemaphoreWait_t wait;
+
+	OS_ASSERT(h);
+
+	while( osMpscRingRead( h, data ) == false )
+	{
+		osThreadEnterCritical();
+		{
+			/* a producer committing the slot afterwards finds the consumer in
+			 * the list and wakes it */
+			wait.result = true;
+			if( ring->committed[ ring->tail & ( ring->itemCount - 1 ) ] == 0 )
+			{
+				wait.result = false;
+				thread_blockCurrent( &ring->readingThreads, timeout, &wait );
+			}
+		}
+		osThreadExitCritical();
+
+		if( wait.result == false )
+			return false;
+	}
+
+	return true;
+}
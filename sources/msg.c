@@ -0,0 +1,316 @@
+/** **************************************************************
+ * @file
+ * @brief Synchronous message passing implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of synchronous message
+ * passing. A client sends a request over a channel and stays blocked until
+ * a server has received the request and replied to it. The request and the
+ * reply are copied once, straight between the buffers of the two threads,
+ * and the server inherits the priority of the clients it is serving.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+#include <string.h>
+
+/**
+ * @brief Copies a message into a buffer, truncating it to the buffer size
+ * @param destination pointer to the buffer
+ * @param capacity size of the buffer in bytes
+ * @param source pointer to the message
+ * @param size size of the message in bytes
+ * @return the number of bytes copied
+ */
+osCounter_t
+msg_copy( void* destination, osCounter_t capacity, const void* source, osCounter_t size )
+{
+	if( size > capacity )
+		size = capacity;
+
+	if( size != 0 )
+		memcpy( destination, source, size );
+
+	return size;
+}
+
+/**
+ * @brief Raises a server and the threads it waits for to a priority
+ * @param server pointer to the thread control block of the server
+ * @param priority the priority of a client that is about to wait for its reply
+ * @details If the server waits for a mutex or for the reply of another server
+ * itself, the priority is passed on along the chain.
+ * @note this function must be used in a critical section
+ */
+void
+msg_inherit( Thread_t* server, osCounter_t priority )
+{
+	OS_ASSERT( criticalNesting );
+
+	while( (server != NULL) && (server->priority > priority) )
+	{
+		thread_changePriority( server, priority );
+
+		if( server->blockingMutex != NULL )
+		{
+			mutex_inherit( server->blockingMutex, priority );
+			break;
+		}
+
+		server = server->blockingServer;
+	}
+}
+
+/**
+ * @brief Lets a server know that a client stopped waiting for its reply
+ * @param client pointer to the thread control block of a client that has
+ * just left the list of the server, due to the reply, a timeout, a suspension
+ * or a deletion
+ * @details The server no longer inherits the priority of the client.
+ * @note this function must be used in a critical section
+ */
+void
+msg_abandonWait( Thread_t* client )
+{
+	Thread_t* server = client->blockingServer;
+
+	OS_ASSERT( criticalNesting );
+
+	client->blockingServer = NULL;
+	mutex_updatePriority( server );
+}
+
+/**
+ * @brief Creates a message channel
+ * @return handle to the channel, if the channel is created successfully;
+ * 0, if the creation failed.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osMsgChannelCreate( void )
+{
+	MsgChannel_t* channel;
+
+	osThreadEnterCritical();
+	channel = memory_allocateFromHeap( sizeof(MsgChannel_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( channel == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	prioritizedList_init( &channel->sendingThreads );
+	prioritizedList_init( &channel->receivingThreads );
+
+	return (osHandle_t) channel;
+}
+
+/**
+ * @brief Deletes a message channel
+ * @param h handle to the channel to be deleted
+ * @details The clients whose requests were not received yet and the servers
+ * waiting for a request will be readied and fail. Requests already received
+ * can still be replied to. The handle should not be used again after calling
+ * this function.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osMsgChannelDelete( osHandle_t h )
+{
+	MsgChannel_t* channel = (MsgChannel_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		thread_makeAllReady( &channel->sendingThreads );
+		thread_makeAllReady( &channel->receivingThreads );
+
+		memory_returnToHeap( channel, & kernelMemoryList );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Sends a request over a channel and waits for the reply
+ * @param h handle to the channel
+ * @param request pointer to the request
+ * @param requestSize size of the request in bytes
+ * @param reply pointer to the buffer for the reply
+ * @param replySize pointer to the size of the reply buffer, set to the size of
+ * the reply received
+ * @param timeout the maximum time in ticks to wait for the reply, 0 for indefinite
+ * @retval true if the reply was received
+ * @retval false if the wait timed out, or the channel or the server was deleted
+ * @details If a server waits on the channel, the request is copied straight
+ * into its buffer. Otherwise the request waits on the channel, in priority order,
+ * until a server receives it. From then on the server runs at least at the
+ * priority of the client.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMsgSend( osHandle_t h, const void* request, osCounter_t requestSize, void* reply,
+		osCounter_t* replySize, osCounter_t timeout )
+{
+	MsgChannel_t* channel = (MsgChannel_t*) h;
+	MsgSendWait_t wait;
+	MsgReceiveWait_t* receiveWait;
+	Thread_t* server;
+
+	OS_ASSERT(h);
+	OS_ASSERT( replySize != NULL );
+
+	osThreadEnterCritical();
+	{
+		wait.request = request;
+		wait.requestSize = requestSize;
+		wait.reply = reply;
+		wait.replySize = *replySize;
+		wait.result = false;
+
+		if( channel->receivingThreads.first != NULL )
+		{
+			/* hand the request to the server waiting with the highest priority */
+			server = (Thread_t*) channel->receivingThreads.first->container;
+			receiveWait = (MsgReceiveWait_t*) server->wait;
+
+			receiveWait->size = msg_copy( receiveWait->data, receiveWait->size, request, requestSize );
+			receiveWait->client = currentThread;
+			receiveWait->result = true;
+			thread_makeReady( server );
+
+			/* wait for the reply, the server runs at the priority of the client meanwhile */
+			currentThread->blockingServer = server;
+			msg_inherit( server, currentThread->priority );
+			thread_blockCurrent( &server->replyingThreads, timeout, &wait );
+		}
+		else
+			thread_blockCurrent( &channel->sendingThreads, timeout, &wait );
+
+		*replySize = wait.result ? wait.replySize : 0;
+	}
+	osThreadExitCritical();
+
+	return wait.result;
+}
+
+/**
+ * @brief Receives a request from a channel
+ * @param h handle to the channel
+ * @param data pointer to the buffer for the request
+ * @param size pointer to the size of the buffer, set to the size of the request
+ * received. A longer request is truncated.
+ * @param timeout the maximum time in ticks to wait for a request, 0 for indefinite
+ * @return handle to the client, to be passed to @ref osMsgReply; 0 if the wait
+ * timed out or the channel was deleted
+ * @details The client with the highest priority is served first. The calling
+ * thread inherits the priority of the client until it replies.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osMsgReceive( osHandle_t h, void* data, osCounter_t* size, osCounter_t timeout )
+{
+	MsgChannel_t* channel = (MsgChannel_t*) h;
+	MsgReceiveWait_t wait;
+	MsgSendWait_t* sendWait;
+	Thread_t* client;
+
+	OS_ASSERT(h);
+	OS_ASSERT( size != NULL );
+
+	osThreadEnterCritical();
+	{
+		wait.data = data;
+		wait.size = *size;
+		wait.client = NULL;
+		wait.result = false;
+
+		if( channel->sendingThreads.first != NULL )
+		{
+			client = (Thread_t*) channel->sendingThreads.first->container;
+			sendWait = (MsgSendWait_t*) client->wait;
+
+			wait.size = msg_copy( data, wait.size, sendWait->request, sendWait->requestSize );
+			wait.client = client;
+			wait.result = true;
+
+			/* the client keeps its timeout, and now waits for the reply */
+			list_remove( &client->schedulerListItem );
+			prioritizedList_insert( (PrioritizedListItem_t*) &client->schedulerListItem,
+					&currentThread->replyingThreads );
+			client->blockingServer = currentThread;
+			msg_inherit( currentThread, client->priority );
+		}
+		else
+			thread_blockCurrent( &channel->receivingThreads, timeout, &wait );
+
+		*size = wait.result ? wait.size : 0;
+	}
+	osThreadExitCritical();
+
+	return (osHandle_t) wait.client;
+}
+
+/**
+ * @brief Replies to a request received by the calling thread
+ * @param client handle to the client returned by @ref osMsgReceive
+ * @param reply pointer to the reply
+ * @param size size of the reply in bytes, truncated to the reply buffer of the
+ * client
+ * @retval true if the reply was copied and the client readied
+ * @retval false if the client no longer waits for the reply, for instance
+ * because it timed out
+ * @details The calling thread gives back the priority it inherited from the
+ * client.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osMsgReply( osHandle_t client, const void* reply, osCounter_t size )
+{
+	Thread_t* thread = (Thread_t*) client;
+	MsgSendWait_t* sendWait;
+	osBool_t result = false;
+
+	OS_ASSERT(client);
+
+	osThreadEnterCritical();
+	{
+		if( thread->blockingServer == currentThread )
+		{
+			sendWait = (MsgSendWait_t*) thread->wait;
+
+			sendWait->replySize = msg_copy( sendWait->reply, sendWait->replySize, reply, size );
+			sendWait->result = true;
+			thread_makeReady( thread );
+
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
+
+			result = true;
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
@@ -10,10 +10,364 @@
 #include "../includes/global.h"
 #include "../includes/functions.h"
 
+/**
+ * @brief Initializes the shared part of a mutex control block
+ * @param mutex pointer to the shared part of the mutex control block
+ * @param ceiling the priority ceiling of the mutex, @ref MUTEX_NO_CEILING if none
+ */
+void
+mutex_init( MutexBase_t* mutex, osCounter_t ceiling )
+{
+	prioritizedList_init( &mutex->threads );
+	notPrioritizedList_init( &mutex->selectors );
+	notPrioritizedList_itemInit( &mutex->heldListItem, mutex );
+	mutex->owner = NULL;
+	mutex->counter = 0;
+	mutex->ceiling = ceiling;
+}
+
+/**
+ * @brief Makes a thread the owner of an unlocked mutex
+ * @param mutex pointer to the shared part of the mutex control block
+ * @param thread pointer to the thread control block of the new owner
+ * @details The thread is raised to the priority ceiling of the mutex, if it has
+ * one, in constant time.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_acquire( MutexBase_t* mutex, Thread_t* thread )
+{
+	OS_ASSERT( criticalNesting );
+	OS_ASSERT( mutex->owner == NULL );
+
+	/* a thread of a priority higher than the ceiling must not use the mutex */
+	OS_ASSERT( (mutex->ceiling == MUTEX_NO_CEILING) || (thread->basePriority >= mutex->ceiling) );
+
+	mutex->owner = thread;
+	mutex->counter = 1;
+	notPrioritizedList_insert( &mutex->heldListItem, &thread->heldMutexes );
+
+	if( mutex->ceiling < thread->priority )
+		thread_changePriority( thread, mutex->ceiling );
+}
+
+/**
+ * @brief Inserts a mutex locked by the atomic fast path into the list of its owner
+ * @param mutex pointer to the shared part of the mutex control block
+ * @details The owner of a mutex locked without a critical section does not know
+ * about it until another thread needs to wait for the mutex, or until the owner
+ * gives up the mutex with a thread already waiting. Does nothing if the mutex is
+ * unlocked or already in the list.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_register( MutexBase_t* mutex )
+{
+	OS_ASSERT( criticalNesting );
+
+	if( (mutex->owner != NULL) && (mutex->heldListItem.list == NULL) )
+	{
+		mutex->counter = 1;
+		notPrioritizedList_insert( &mutex->heldListItem, &mutex->owner->heldMutexes );
+	}
+}
+
+/**
+ * @brief Releases a mutex from its owner
+ * @param mutex pointer to the shared part of the mutex control block, which
+ * must be locked
+ * @details The mutex is passed to the first highest priority waiting thread, if
+ * any, which inherits the priorities of the remaining waiting threads. Otherwise
+ * the mutex is unlocked. The priority of the old owner is restored to the highest
+ * of its base priority and the priorities inherited from its other mutexes.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_handOff( MutexBase_t* mutex )
+{
+	Thread_t* owner = mutex->owner;
+	Thread_t* thread;
+
+	OS_ASSERT( criticalNesting );
+	OS_ASSERT( owner != NULL );
+
+	if( mutex->heldListItem.list != NULL )
+		list_remove( &mutex->heldListItem );
+
+	mutex->owner = NULL;
+	mutex->counter = 0;
+
+	if( mutex->threads.first != NULL )
+	{
+		thread = (Thread_t*) mutex->threads.first->container;
+
+		/* the thread leaves the waiting list with the mutex, not abandoning it */
+		thread->blockingMutex = NULL;
+		((MutexWait_t*) thread->wait)->result = true;
+		thread_makeReady( thread );
+
+		mutex_acquire( mutex, thread );
+		mutex_updatePriority( thread );
+	}
+	else
+		waitAny_notify( &mutex->selectors );
+
+	mutex_updatePriority( owner );
+}
+
+/**
+ * @brief Raises the owners of a chain of mutexes to a priority
+ * @param mutex pointer to the shared part of the mutex control block a thread
+ * of the given priority is about to block on
+ * @param priority the priority of the thread
+ * @details The owner of the mutex inherits the priority. If the owner is blocked
+ * on another mutex itself, the owner of that mutex inherits it as well, and so on
+ * along the chain.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_inherit( MutexBase_t* mutex, osCounter_t priority )
+{
+	Thread_t* owner;
+
+	OS_ASSERT( criticalNesting );
+
+	while( mutex != NULL )
+	{
+		owner = mutex->owner;
+
+		/* stop once an owner already runs at this priority or higher */
+		if( (owner == NULL) || (owner->priority <= priority) )
+			break;
+
+		thread_changePriority( owner, priority );
+
+		/* an owner waiting for a reply passes the priority on to the server */
+		if( owner->blockingServer != NULL )
+			msg_inherit( owner->blockingServer, priority );
+
+		mutex = owner->blockingMutex;
+	}
+}
+
+/**
+ * @brief Recalculates the priority of a thread after its waiting threads changed
+ * @param thread pointer to the thread control block
+ * @details The priority of the thread becomes the highest of its base priority,
+ * the priority ceilings and the priorities of the first waiting threads of all the
+ * mutexes it owns, and the priority of the first thread waiting for its reply. If
+ * the priority changes and the thread is blocked on a mutex or for a reply, the
+ * priority of the owner of that mutex or of the server is recalculated as well,
+ * and so on along the chain.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_updatePriority( Thread_t* thread )
+{
+	osCounter_t priority, waiterPriority;
+	NotPrioritizedListItem_t* i;
+	MutexBase_t* mutex;
+
+	OS_ASSERT( criticalNesting );
+
+	while( thread != NULL )
+	{
+		priority = thread->basePriority;
+
+		/* the first thread in a waiting list has the highest priority in the list */
+		i = thread->heldMutexes.first;
+		if( i != NULL )
+		{
+			do
+			{
+				mutex = (MutexBase_t*) i->container;
+
+				if( mutex->ceiling < priority )
+					priority = mutex->ceiling;
+
+				if( mutex->threads.first != NULL )
+				{
+					waiterPriority = ((Thread_t*) mutex->threads.first->container)->priority;
+
+					if( waiterPriority < priority )
+						priority = waiterPriority;
+				}
+
+				i = i->next;
+
+			} while( i != thread->heldMutexes.first );
+		}
+
+		/* clients waiting for a reply donate their priority */
+		if( thread->replyingThreads.first != NULL )
+		{
+			waiterPriority = ((Thread_t*) thread->replyingThreads.first->container)->priority;
+
+			if( waiterPriority < priority )
+				priority = waiterPriority;
+		}
+
+		if( priority == thread->priority )
+			break;
+
+		thread_changePriority( thread, priority );
+
+		/* pass the change on to the owner of the mutex or the server the thread is waiting for */
+		if( thread->blockingMutex != NULL )
+			thread = thread->blockingMutex->owner;
+		else
+			thread = thread->blockingServer;
+	}
+}
+
+/**
+ * @brief Lets the owner of a mutex know that a thread stopped waiting
+ * @param thread pointer to the thread control block of a thread that has just
+ * left the waiting list of the mutex without getting it, due to a timeout, a
+ * suspension or a deletion
+ * @details The owner no longer inherits the priority of the thread.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_abandonWait( Thread_t* thread )
+{
+	MutexBase_t* mutex = thread->blockingMutex;
+
+	OS_ASSERT( criticalNesting );
+	OS_ASSERT( mutex != NULL );
+
+	thread->blockingMutex = NULL;
+
+	if( mutex->owner != NULL )
+	{
+		mutex_updatePriority( mutex->owner );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+}
+
+/**
+ * @brief Releases all the mutexes owned by a thread
+ * @param thread pointer to the thread control block of a thread being deleted
+ * @details Each mutex is passed to its first highest priority waiting thread, or
+ * unlocked if there is none.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_releaseAll( Thread_t* thread )
+{
+	OS_ASSERT( criticalNesting );
+
+	while( thread->heldMutexes.first != NULL )
+		mutex_handOff( (MutexBase_t*) thread->heldMutexes.first->container );
+}
+
+/**
+ * @brief Readies all the threads waiting for a mutex that is being deleted
+ * @param mutex pointer to the shared part of the mutex control block
+ * @details The mutex is taken away from its owner first, which stops inheriting
+ * the priorities of the waiting threads. The blocks of the waiting threads fail.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_destroy( MutexBase_t* mutex )
+{
+	Thread_t* owner = mutex->owner;
+
+	OS_ASSERT( criticalNesting );
+
+	if( owner != NULL )
+	{
+		if( mutex->heldListItem.list != NULL )
+			list_remove( &mutex->heldListItem );
+
+		mutex->owner = NULL;
+		mutex_updatePriority( owner );
+	}
+
+	/* the waiting threads abandon a mutex without owner */
+	thread_makeAllReady( &mutex->threads );
+	waitAny_notify( &mutex->selectors );
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+
+/**
+ * @brief Blocks current thread on a locked mutex
+ * @param mutex pointer to the shared part of the mutex control block
+ * @param timeout maximum time to wait for the mutex, 0 for indefinite
+ * @retval true if the mutex was passed to current thread
+ * @retval false if timeout or failed
+ * @details The owner of the mutex inherits the priority of current thread,
+ * transitively along a chain of mutexes, before current thread blocks.
+ * @note this function must be used in a critical section
+ */
+osBool_t
+mutex_blockCurrent( MutexBase_t* mutex, osCounter_t timeout )
+{
+	MutexWait_t wait;
+
+	OS_ASSERT( criticalNesting );
+	OS_ASSERT( mutex->owner != currentThread );
+
+	wait.result = false;
+
+	/* the owner needs to know about the mutex in order to give back the priority */
+	mutex_register( mutex );
+
+	currentThread->blockingMutex = mutex;
+	mutex_inherit( mutex, currentThread->priority );
+
+	thread_blockCurrent( &mutex->threads, timeout, & wait );
+
+	return wait.result;
+}
+
+#if OS_USE_ATOMICS
+/**
+ * @brief Completes an atomic release of a mutex that turned out to be contended
+ * @param mutex pointer to the shared part of the mutex control block
+ * @param previous pointer to the thread control block of the thread that released
+ * the mutex
+ * @details A thread may have started waiting for the mutex between the check and
+ * the atomic release of the fast path. If the mutex is still unlocked, it is passed
+ * to the first highest priority waiting thread. If another thread locked it through
+ * the fast path in the meantime, the new owner takes over the waiting threads.
+ * @note this function must be used in a critical section
+ */
+void
+mutex_settle( MutexBase_t* mutex, Thread_t* previous )
+{
+	OS_ASSERT( criticalNesting );
+
+	if( mutex->owner == NULL )
+	{
+		/* release as if the previous owner had never let go */
+		mutex->owner = previous;
+		mutex_handOff( mutex );
+	}
+	else
+	{
+		list_remove( &mutex->heldListItem );
+		mutex_updatePriority( previous );
+
+		mutex_register( mutex );
+		mutex_updatePriority( mutex->owner );
+	}
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+#endif
+
 /**
  * @brief Creates a mutex.
  * @return handle to the created mutex, if mutex successfully created;
  * 	0, if mutex creation failed.
+ * @details The owner of the mutex inherits the priority of the highest priority
+ * thread blocked for the mutex, see @ref osMutexLock.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- Yes: main stack context before the kernel started
@@ -36,8 +390,52 @@ osMutexCreate( void )
 	}
 
 	/* initialize the mutex control block */
-	mutex->locked = false;
-	prioritizedList_init( &mutex->threads );
+	mutex_init( &mutex->base, MUTEX_NO_CEILING );
+
+	return (osHandle_t) mutex;
+}
+
+/**
+ * @brief Creates a mutex with a priority ceiling.
+ * @param priority the priority ceiling, which is the highest priority of all the
+ * threads that lock the mutex, other than @ref OS_EDF_PRIORITY if @ref OS_USE_EDF
+ * is enabled
+ * @return handle to the created mutex, if mutex successfully created;
+ * 	0, if mutex creation failed.
+ * @details The mutex follows the immediate priority ceiling protocol. A thread that
+ * locks the mutex is raised to the ceiling right away in constant time, so that none
+ * of the other threads using the mutex can preempt it until it unlocks the mutex. As
+ * long as the owner does not block while holding the mutex, no thread ever waits for
+ * it, which rules out priority inversion and chained blocking without the waiting
+ * list walks of priority inheritance. Threads with a priority higher than the ceiling
+ * must not lock the mutex.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osMutexCreateCeiling( osCounter_t priority )
+{
+	Mutex_t* mutex;
+
+	OS_ASSERT( priority < OS_PRIO_COUNT );
+#if OS_USE_EDF
+	/* a ceiling cannot order the EDF threads by deadline */
+	OS_ASSERT( priority != OS_EDF_PRIORITY );
+#endif
+
+	osThreadEnterCritical();
+	mutex = memory_allocateFromHeap( sizeof(Mutex_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( mutex == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	mutex_init( &mutex->base, priority );
 
 	return (osHandle_t) mutex;
 }
@@ -64,14 +462,8 @@ osMutexDelete( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		/* unblock all threads */
-		thread_makeAllReady( & mutex->threads );
-
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		/* take the mutex from its owner and unblock all threads */
+		mutex_destroy( &mutex->base );
 
 		/* free the mutex control block */
 		memory_returnToHeap( mutex, & kernelMemoryList );
@@ -107,7 +499,7 @@ osMutexPeekLock( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		result = mutex->locked == false;
+		result = mutex->base.owner == NULL;
 	}
 	osThreadExitCritical();
 
@@ -119,6 +511,8 @@ osMutexPeekLock( osHandle_t h )
  * @param h handle to the mutex to be locked.
  * @retval true if the mutex is locked
  * @retval false if the mutex cannot be locked
+ * @details Current thread becomes the owner of the mutex. When called in an
+ * interrupt context, the interrupted thread becomes the owner.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- Yes: main stack context before the kernel started
@@ -132,11 +526,17 @@ osMutexLockNonBlock( osHandle_t h )
 
 	OS_ASSERT(h);
 
+#if OS_USE_ATOMICS
+	/* a mutex without ceiling is locked with a single atomic operation */
+	if( mutex->base.ceiling == MUTEX_NO_CEILING )
+		return OS_ATOMIC_CAS( &mutex->base.owner, NULL, currentThread );
+#endif
+
 	osThreadEnterCritical();
 	{
-		if( mutex->locked == false )
+		if( mutex->base.owner == NULL )
 		{
-			mutex->locked = true;
+			mutex_acquire( &mutex->base, currentThread );
 			result = true;
 		}
 	}
@@ -155,6 +555,15 @@ osMutexLockNonBlock( osHandle_t h )
  * This function will block the current thread forever or for a specified amount
  * of time to lock the mutex if it cannot be locked initially. This function cannot
  * be used in an interrupt context, see @ref osMutexLockNonBlock .
+ *
+ * While current thread is blocked, the owner of the mutex inherits its priority if
+ * it is higher. If the owner is blocked on another mutex, the owner of that mutex
+ * inherits the priority too, and so on. The inherited priority is given up when the
+ * mutex is unlocked, or when current thread stops waiting.
+ *
+ * If @ref OS_USE_ATOMICS is enabled, an unlocked mutex without ceiling is locked with
+ * a single atomic operation. A thread deleted while holding such a mutex releases it
+ * only if another thread has been waiting for it.
  * @note contexts in which this function can be used
  * 	- No: an interrupt context
  * 	- No: main stack context before the kernel started
@@ -165,24 +574,25 @@ osMutexLock( osHandle_t h, osCounter_t timeout )
 {
 	osBool_t result = false;
 	Mutex_t* mutex = (Mutex_t*) h;
-	MutexWait_t wait;
 
 	OS_ASSERT(h);
 
+#if OS_USE_ATOMICS
+	/* uncontended fast path, a mutex without ceiling is locked with a single atomic operation */
+	if( (mutex->base.ceiling == MUTEX_NO_CEILING) &&
+		OS_ATOMIC_CAS( &mutex->base.owner, NULL, currentThread ) )
+		return true;
+#endif
+
 	osThreadEnterCritical();
 	{
-		if( mutex->locked == false )
+		if( mutex->base.owner == NULL )
 		{
 			result = true;
-			mutex->locked = true;
+			mutex_acquire( &mutex->base, currentThread );
 		}
 		else
-		{
-			wait.result = false;
-			thread_blockCurrent( &mutex->threads, timeout, & wait );
-
-			result = wait.result;
-		}
+			result = mutex_blockCurrent( &mutex->base, timeout );
 	}
 	osThreadExitCritical();
 
@@ -192,6 +602,8 @@ osMutexLock( osHandle_t h, osCounter_t timeout )
 /**
  * @brief Unlocks a mutex.
  * @param h handle to the mutex to be unlocked
+ * @details The mutex is passed to the first highest priority thread waiting for it,
+ * if any. The priority the owner inherited through the mutex is given up.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- No: main stack context before the kernel started
@@ -201,34 +613,38 @@ void
 osMutexUnlock( osHandle_t h )
 {
 	Mutex_t* mutex = (Mutex_t*) h;
-	Thread_t* thread;
-	MutexWait_t* wait;
 
 	OS_ASSERT(h);
 
-	osThreadEnterCritical();
+#if OS_USE_ATOMICS
+	/* uncontended fast path, no thread has been waiting for the mutex, so it is not in
+	 * the list of its owner */
+	if( (mutex->base.heldListItem.list == NULL) &&
+		OS_ATOMIC_CAS( &mutex->base.owner, currentThread, NULL ) )
 	{
-		if( mutex->locked )
+		/* a thread started waiting between the check and the release */
+		if( mutex->base.heldListItem.list != NULL )
 		{
-			/* pass the lock to the first highest priority thread if there are threads waiting */
-			if( mutex->threads.first != NULL )
+			osThreadEnterCritical();
 			{
-				thread = (Thread_t*) mutex->threads.first->container;
-				wait = (MutexWait_t*) thread->wait;
+				mutex_settle( &mutex->base, currentThread );
+			}
+			osThreadExitCritical();
+		}
 
-				wait->result = true;
-				thread_makeReady( thread );
+		return;
+	}
+#endif
 
-				if( thread->priority < currentThread->priority )
-				{
-					thread_setNew();
-					port_yield();
-				}
-			}
-			else
-			{
-				mutex->locked = false;
-			}
+	osThreadEnterCritical();
+	{
+		if( mutex->base.owner != NULL )
+		{
+			/* pass the lock to the first highest priority thread if there are threads waiting */
+			mutex_handOff( &mutex->base );
+
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
 		}
 	}
 	osThreadExitCritical();
@@ -238,6 +654,8 @@ osMutexUnlock( osHandle_t h )
  * @brief Creates a recursive mutex.
  * @return handle to the mutex, if the mutex is created successfully;
  * 	0, if the creation failed.
+ * @details The owner of the recursive mutex inherits the priority of the highest
+ * priority thread blocked for it, see @ref osMutexLock.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- Yes: main stack context before the kernel started
@@ -255,9 +673,7 @@ osRecursiveMutexCreate( void )
 	if( mutex == NULL )
 		return 0;
 
-	mutex->counter = 0;
-	mutex->owner = NULL;
-	prioritizedList_init( &mutex->threads );
+	mutex_init( &mutex->base, MUTEX_NO_CEILING );
 
 	return (osHandle_t) mutex;
 }
@@ -276,7 +692,7 @@ osRecursiveMutexCreate( void )
  * 	- Yes: thread contexts
  */
 void
-osRecursiveMtuexDelete( osHandle_t h )
+osRecursiveMutexDelete( osHandle_t h )
 {
 	RecursiveMutex_t* mutex = (RecursiveMutex_t*) h;
 
@@ -284,13 +700,7 @@ osRecursiveMtuexDelete( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		thread_makeAllReady( & mutex->threads );
-
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		mutex_destroy( &mutex->base );
 
 		memory_returnToHeap( mutex, & kernelMemoryList );
 	}
@@ -328,7 +738,7 @@ osRecursiveMutexPeekLock( osHandle_t h )
 	osThreadEnterCritical();
 	{
 		/* non-atomic read, must be in critical section */
-		result = ( ( mutex->counter == 0 ) || ( mutex->owner == currentThread ) );
+		result = ( ( mutex->base.owner == NULL ) || ( mutex->base.owner == currentThread ) );
 	}
 	osThreadExitCritical();
 
@@ -360,7 +770,7 @@ osRecursiveMutexIsLocked( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		result = mutex->counter != 0;
+		result = mutex->base.owner != NULL;
 	}
 	osThreadExitCritical();
 
@@ -387,10 +797,14 @@ osRecursiveMutexLockNonBlock( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		if( ( mutex->counter == 0 ) || ( mutex->owner = currentThread ) )
+		if( mutex->base.owner == NULL )
 		{
-			mutex->counter++;
-			mutex->owner = currentThread;
+			mutex_acquire( &mutex->base, currentThread );
+			result = true;
+		}
+		else if( mutex->base.owner == currentThread )
+		{
+			mutex->base.counter++;
 			result = true;
 		}
 	}
@@ -405,6 +819,8 @@ osRecursiveMutexLockNonBlock( osHandle_t h )
  * @param timeout maximum time to wait for the recursive mutex to be locked, 0 for indefinite
  * @retval true if the recursive mutex is locked
  * @retval false if timeout or failed
+ * @details The owner inherits the priority of current thread while it is blocked,
+ * as with @ref osMutexLock.
  * @note contexts in which this function can be used
  * 	- No: an interrupt context
  * 	- No: main stack context before the kernel started
@@ -414,25 +830,24 @@ osBool_t
 osRecursiveMutexLock( osHandle_t h, osCounter_t timeout )
 {
 	RecursiveMutex_t* mutex = (RecursiveMutex_t*) h;
-	MutexWait_t wait;
 	osBool_t result = false;
 
 	OS_ASSERT(h);
 
 	osThreadEnterCritical();
 	{
-		if( ( mutex->counter == 0 ) || ( mutex->owner == currentThread ) )
+		if( mutex->base.owner == NULL )
 		{
-			mutex->counter++;
-			mutex->owner = currentThread;
+			mutex_acquire( &mutex->base, currentThread );
 			result = true;
 		}
-		else
+		else if( mutex->base.owner == currentThread )
 		{
-			wait.result = false;
-			thread_blockCurrent( &mutex->threads, timeout, & wait );
-			result = wait.result;
+			mutex->base.counter++;
+			result = true;
 		}
+		else
+			result = mutex_blockCurrent( &mutex->base, timeout );
 	}
 	osThreadExitCritical();
 
@@ -451,47 +866,25 @@ void
 osRecursiveMutexUnlock( osHandle_t h )
 {
 	RecursiveMutex_t* mutex = (RecursiveMutex_t*) h;
-	Thread_t* thread;
-	MutexWait_t* wait;
 
 	OS_ASSERT(h);
 
 	osThreadEnterCritical();
 	{
 		/* only unlocks if current thread owns the mutex */
-		if( mutex->owner == currentThread )
+		if( mutex->base.owner == currentThread )
 		{
-			if( mutex->counter > 1 )
-				mutex->counter--;
-
-			else if( mutex->counter == 1 )
-			{
-				/* if there are waiting threads, pass the lock to the first highest priority thread */
-				if( mutex->threads.first != NULL )
-				{
-					thread = (Thread_t*) mutex->threads.first->container;
-					wait = (MutexWait_t*) thread->wait;
+			if( mutex->base.counter > 1 )
+				mutex->base.counter--;
 
-					mutex->owner = thread;
-
-					wait->result = true;
-					thread_makeReady( thread );
-
-					if( thread->priority < currentThread->priority )
-					{
-						thread_setNew();
-						port_yield();
-					}
-				}
-				else
-				{
-					/* no threads are waiting, unlock the mutex */
-					mutex->counter = 0;
-				}
-			}
 			else
 			{
-				/* mutex counter == 0, trying to unlock an unlocked mutex, do nothing. */
+				/* if there are waiting threads, pass the lock to the first highest priority
+				 * thread, otherwise unlock the mutex */
+				mutex_handOff( &mutex->base );
+
+				if( thread_isPreemptionNeeded() )
+					thread_requestReschedule();
 			}
 		}
 	}
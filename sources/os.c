@@ -32,7 +32,14 @@ osInit( void )
 	/* initialize the global counters. Although this might already
 	 * been done when the BSS section is cleared. */
 	systemTime = 0;
+	systemTimeSequence = 0;
 	criticalNesting = 0;
+	interruptNesting = 0;
+	schedulerSuspendNesting = 0;
+
+	reschedulePending = false;
+	rescheduleRequestCounter = 0;
+	rescheduleMergedCounter = 0;
 
 	/* initialize the heap */
 	memory_heapInit();
@@ -42,29 +49,44 @@ osInit( void )
 	osCounter_t size = (osByte_t*) OS_HEAP_END_ADDR - (osByte_t*) OS_HEAP_START_ADDR;
 
 	memory_blockCreate( block, size );
+
+	/* the heap functions expect a critical section */
+	osThreadEnterCritical();
 	memory_blockInsertToHeap( block );
+	osThreadExitCritical();
 
 	/* initialize the kernel memory list */
 	memory_listInit( & kernelMemoryList );
 
 	/* initialize the scheduling lists */
-	prioritizedList_init( & threads_timed );
-	prioritizedList_init( & threads_ready );
+	timingWheel_init( & threads_timed );
+	thread_readyListInit();
 
-	/* initialize the timer priority list */
+	/* initialize the timer priority list and the timer wheel */
 	notPrioritizedList_init( & timerPriorityList );
+	timingWheel_init( & timers_timed );
+
+#if OS_USE_CPU_BUDGET
+	timingWheel_init( & budgets_timed );
+#endif
 
 	/* create the idle thread */
 	thread_init( &idleThread );
 	idleThread.stackMemory = idleThreadStack;
 	/* fill the stack with an initial fake thread context, which will be
 	 * loaded into the CPU by the context switcher */
+#if OS_USE_TICKLESS_IDLE
+	idleThread.PSP = port_makeFakeContext( idleThreadStack, OS_IDLE_THREAD_STACK_SIZE, (osCode_t) os_idleTask, 0 );
+#else
 	idleThread.PSP = port_makeFakeContext( idleThreadStack, OS_IDLE_THREAD_STACK_SIZE, port_idle, 0 );
+#endif
 	idleThread.priority = OS_PRIO_LOWEST;
+	idleThread.basePriority = OS_PRIO_LOWEST;
+	idleThread.preemptionThreshold = OS_PRIO_LOWEST;
 	idleThread.state = OSTHREAD_READY;
 
-	/* add the idle thread to the ready list */
-	prioritizedList_insert( (PrioritizedListItem_t*) ( &idleThread.schedulerListItem ), &threads_ready );
+	/* add the idle thread to the ready queue */
+	thread_readyInsert( &idleThread );
 
 	/* initialize the variables used for scheduling */
 	currentThread = &idleThread;
@@ -79,10 +101,11 @@ osInit( void )
 void
 osStart( void )
 {
-	/* load current thread pointer from the highest priority thread in the ready list
+	/* load current thread pointer from the highest priority thread in the ready queue
 	 * currentThread will be loaded into the CPU by port_startKernel
 	 */
-	currentThread = (Thread_t*) ( threads_ready.first->container );
+	nextThread = (Thread_t*) ( threads_ready.levels[ thread_getHighestReadyPriority() ].first->container );
+	currentThread = nextThread;
 	port_startKernel();
 }
 
@@ -94,82 +117,305 @@ osStart( void )
 OS_INTERRUPT void
 OS_TICK_HANDLER_NAME( void )
 {
-	Thread_t* thread;
-	PrioritizedListItem_t* listItem;
-
 	osThreadEnterCritical();
 	{
 		/* increment system time */
-		systemTime++;
+		os_advanceTime(1);
+
+		/* ready the timed-out threads and hand the expired timers to their daemons,
+		 * only the slot of this tick is visited in both wheels */
+		thread_readyTimedOut(1);
+		timer_readyExpired(1);
 
-		/* ready the timed-out threads in the timing list */
-		while( threads_timed.first != NULL )
+#if OS_USE_CPU_BUDGET
+		/* restore the replenished budgets, and charge this tick to current thread */
+		thread_replenishBudgets(1);
+		thread_chargeBudget();
+#endif
+
+		/* the scheduler is suspended, the threads readied above are scheduled when it resumes */
+		if( schedulerSuspendNesting != 0 )
+			reschedulePending = true;
+
+		else
 		{
-			/* get the first thread */
-			listItem = threads_timed.first;
-			thread = (Thread_t*) listItem->container;
+			/* Perform round-robin scheduling
+			 *
+			 * The kernel allows multiple threads with same priority. Ready threads with
+			 * the same priority are kept in a circular list in the ready queue, and CPU
+			 * time will be shared among them.
+			 *
+			 * charge the tick to the time slice of current thread. Once the time slice
+			 * is used up, set the nextThread pointer to the next thread after current
+			 * thread in its priority level. Call thread_setNew to re-schedule in both
+			 * cases. Since thread_setNew will automatically check the priority of
+			 * nextThread, nextThread will be set to the highest priority level if its
+			 * priority is no longer the highest. All steps take constant time.
+			 */
 
-			if( systemTime >= listItem->value )
-				thread_makeReady( thread );
+			/* next thread have to be in the ready queue */
+			OS_ASSERT( thread_isReady(nextThread) );
 
-			else
-				/* since the items in the threads_timed list are
-				 * organized in incremental order by their timeout value,
-				 * it is not necessary to continue */
-				break;
-		}
+			/* a time slice of 0 means that the thread is never rotated by the tick */
+			if( currentThread->timeSlice != 0 )
+			{
+				if( currentThread->timeSliceLeft > 1 )
+					currentThread->timeSliceLeft--;
+
+				else
+				{
+					/* time slice used up, refill it and move nextThread to the next item */
+					currentThread->timeSliceLeft = currentThread->timeSlice;
+					currentThread->timeSliceCounter++;
+
+					nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
+				}
+			}
 
-		/* Perform round-robin scheduling
-		 *
-		 * The kernel allows multiple threads with same priority. All ready threads
-		 * with the highest priority are organized at the front of threads_ready, and CPU]
-		 * time will be shared among them.
-		 *
-		 * set the nextThread pointer to the next thread after current thread,
-		 * and call thread_setNew to re-schedule. Since thread_setNew will automatically
-		 * check the priority of nextThread, nextThread will be set back to the
-		 * beginning of the list if its priority is no longer the highest.
-		 */
-
-		/* next thread have to be in the ready list */
-		OS_ASSERT( nextThread->schedulerListItem.list == (void*)(&threads_ready) );
-
-		/* move nextThread to the next item, and call the scheduler function to check if
-		 * it should be run next. */
-		/* there's at least one thread (the idle thread) in the ready list */
-		nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
-
-		/* next thread have to be in the ready list */
-		OS_ASSERT( nextThread->schedulerListItem.list == (void*)(&threads_ready) );
-
-		thread_setNew();
-
-		/* send yield request if scheduling gives a different thread */
-		if( currentThread != nextThread )
-			port_yield();
+			/* reschedule now, which clears the reschedule requested above, so that
+			 * the critical section does not exit with a second one */
+			thread_reschedule();
+		}
 	}
 	osThreadExitCritical();
 }
 
+#if OS_USE_TICKLESS_IDLE
+/**
+ * @brief Returns the number of ticks the idle thread may sleep
+ * @return the number of ticks until the earliest thread timeout or timer expiry,
+ * 0 if the idle thread should not sleep, or OS_TICKLESS_INFINITE_IDLE if nothing
+ * is waiting for a timeout.
+ * @details The idle thread may only sleep when it is the only ready thread, so that
+ * round-robin time slicing among other ready threads keeps being driven by the tick.
+ * The earliest wake up time is the minimum of the earliest thread timeout in
+ * @ref threads_timed and the earliest timer expiry in @ref timers_timed, and of the
+ * earliest budget replenishment if CPU budgets are enabled.
+ * @note this function must be used in a critical section
+ */
+osCounter_t
+os_getIdleTicks( void )
+{
+	osCounter_t ticks, timerTicks;
+
+	/* this function has to be called in a critical section because it accesses global variables */
+	OS_ASSERT( criticalNesting );
+
+	/* other ready threads are sharing the CPU, keep the tick running */
+	if( (thread_getHighestReadyPriority() != idleThread.priority) ||
+		(idleThread.schedulerListItem.next != &idleThread.schedulerListItem) )
+		return 0;
+
+	ticks = timingWheel_getTicksToNext( &threads_timed );
+	timerTicks = timingWheel_getTicksToNext( &timers_timed );
+
+	if( timerTicks < ticks )
+		ticks = timerTicks;
+
+#if OS_USE_CPU_BUDGET
+	/* a replenishment may raise a waiting thread back to its priority */
+	timerTicks = timingWheel_getTicksToNext( &budgets_timed );
+
+	if( timerTicks < ticks )
+		ticks = timerTicks;
+#endif
+
+	return ticks;
+}
+
+/**
+ * @brief The tickless idle thread
+ * @details Whenever the idle thread is the only ready thread and the next wake up
+ * is far enough away, the periodic tick is suppressed until then by calling
+ * @ref port_suppressTicks. The ticks that elapsed during the sleep are added to
+ * @ref systemTime afterwards and the timed-out threads are readied, as if the
+ * tick handler had run for each of them. Otherwise the idle thread sleeps until
+ * the next interrupt by calling @ref port_sleep.
+ */
+void
+os_idleTask( void )
+{
+	osCounter_t ticks;
+
+	for( ; ; )
+	{
+		osThreadEnterCritical();
+		{
+			ticks = os_getIdleTicks();
+
+			if( ticks >= OS_TICKLESS_MIN_IDLE_TICKS )
+			{
+				if( ticks == OS_TICKLESS_INFINITE_IDLE )
+					ticks = 0;
+
+				/* catch up with the ticks skipped during the sleep */
+				ticks = port_suppressTicks( ticks );
+				os_advanceTime( ticks );
+				thread_readyTimedOut( ticks );
+				timer_readyExpired( ticks );
+#if OS_USE_CPU_BUDGET
+				thread_replenishBudgets( ticks );
+#endif
+
+				thread_reschedule();
+			}
+			else
+				/* the next wake up is too close to stop the tick, sleep until the
+				 * next interrupt instead of spinning */
+				port_sleep();
+		}
+		osThreadExitCritical();
+	}
+}
+#endif
+
+/**
+ * @brief Advances the system time
+ * @param ticks the number of ticks elapsed
+ * @details The sequence counter is made odd during the update, so that a concurrent
+ * lock-free read in @ref osGetTime notices the update and reads again.
+ * @note this function must be used in a critical section
+ */
+void
+os_advanceTime( osCounter_t ticks )
+{
+	OS_ASSERT( criticalNesting );
+
+	systemTimeSequence++;
+	OS_MEMORY_BARRIER();
+
+	systemTime += ticks;
+
+	OS_MEMORY_BARRIER();
+	systemTimeSequence++;
+}
+
 /**
  * @brief Returns the current operating system time
  * @return The current global operating system time in ticks elapsed since the
  * start of the operating system.
  * @details This function returns the global operating system time, expressed in
- * ticks elapsed since the start of the operating system. With a 32 bit unsigned
- * integer counter and an 100 Hz tick frequency, it will overflow in about 1.36 years,
- * or 1 year and 4 months.
+ * ticks elapsed since the start of the operating system. The 64 bit counter will
+ * not overflow during the life time of a device.
+ *
+ * The function does not enter a critical section. It reads the sequence counter
+ * before and after reading the system time, and reads again if the system time
+ * was updated in between.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
  */
-osCounter_t
+osTime_t
 osGetTime( void )
+{
+	osCounter_t sequence;
+	osTime_t ret;
+
+	do
+	{
+		sequence = systemTimeSequence;
+		OS_MEMORY_BARRIER();
+
+		ret = systemTime;
+
+		OS_MEMORY_BARRIER();
+
+	} while( (sequence & 1) || (sequence != systemTimeSequence) );
+
+	return ret;
+}
+
+/**
+ * @brief Marks the entry of an interrupt handler
+ * @details Interrupt handlers that call kernel functions can call this function
+ * on entry and @ref osInterruptExit on exit. Reschedules requested by the kernel
+ * functions in between, for example by posting to several semaphores, are then
+ * merged and performed once on exit of the outermost handler.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- No: thread contexts
+ */
+void
+osInterruptEnter( void )
+{
+	osThreadEnterCritical();
+	{
+		interruptNesting++;
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Marks the exit of an interrupt handler
+ * @details Performs the reschedule requested during the outermost interrupt
+ * handler, if any.
+ *
+ * @see osInterruptEnter
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- No: thread contexts
+ */
+void
+osInterruptExit( void )
+{
+	osThreadEnterCritical();
+	{
+		OS_ASSERT( interruptNesting );
+		interruptNesting--;
+
+		/* the pending reschedule, if any, is performed when the critical section exits */
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Returns the number of reschedule requests
+ * @return the number of times a wake-up path requested a reschedule since the
+ * operating system was initialized
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osGetRescheduleRequestCounter( void )
 {
 	osCounter_t ret;
 
-	/* a critical section is necessary since the read on osCounter might
-	 * take multiple instructions to complete */
 	osThreadEnterCritical();
 	{
-		ret = systemTime;
+		ret = rescheduleRequestCounter;
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+
+/**
+ * @brief Returns the number of merged reschedule requests
+ * @return the number of reschedule requests that arrived while another request
+ * was pending, and therefore did not cause a yield of their own
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osGetRescheduleMergedCounter( void )
+{
+	osCounter_t ret;
+
+	osThreadEnterCritical();
+	{
+		ret = rescheduleMergedCounter;
 	}
 	osThreadExitCritical();
 
@@ -9,26 +9,45 @@
 #include "../includes/global.h"
 #include "../includes/functions.h"
 
+#include <string.h>
+
+/**
+ * @brief Wraps a position that is less than twice the queue size around the
+ * queue memory
+ * @param queue pointer to the queue
+ * @param position the position to be wrapped
+ */
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+#define QUEUE_WRAP(queue, position) 	( (position) & ( (queue)->size - 1 ) )
+#else
+#define QUEUE_WRAP(queue, position) \
+	( (position) >= (queue)->size ? (position) - (queue)->size : (position) )
+#endif
+
 /**
  * @brief Writes data to the queue
  * @param queue pointer to the queue where data is to be written
  * @param data pointer to the data to be written
  * @param size size of the data in bytes
+ * @details The data is copied in at most two contiguous pieces, up to the end
+ * of the queue memory and from its start.
  */
 void
 queue_write( Queue_t* queue, const void* data, osCounter_t size )
 {
-	osCounter_t counter = 0;
+	osCounter_t first = queue->size - queue->write;
 
-	for( ; counter < size; counter++ )
-	{
-		queue->memory[queue->write] = ( (const osByte_t*) data )[counter];
+	OS_ASSERT( size <= queue_getFreeSize(queue) );
 
-		if( queue->write < queue->size - 1 )
-			queue->write++;
-		else
-			queue->write = 0;
-	}
+	if( first > size )
+		first = size;
+
+	memcpy( &queue->memory[queue->write], data, first );
+
+	if( size > first )
+		memcpy( queue->memory, (const osByte_t*) data + first, size - first );
+
+	queue->write = QUEUE_WRAP( queue, queue->write + size );
 }
 
 /**
@@ -36,21 +55,63 @@ queue_write( Queue_t* queue, const void* data, osCounter_t size )
  * @param queue pointer to the queue where data is to be read
  * @param data pointer to the buffer data to be put in
  * @param size size of the data in bytes
+ * @details The data is copied in at most two contiguous pieces, up to the end
+ * of the queue memory and from its start.
  */
 void
 queue_read( Queue_t* queue, void* data, osCounter_t size )
 {
-	osCounter_t counter = 0;
+	osCounter_t first = queue->size - queue->read;
+
+	OS_ASSERT( size <= queue_getUsedSize(queue) );
+
+	if( first > size )
+		first = size;
+
+	memcpy( data, &queue->memory[queue->read], first );
+
+	if( size > first )
+		memcpy( (osByte_t*) data + first, queue->memory, size - first );
+
+	queue->read = QUEUE_WRAP( queue, queue->read + size );
+}
+
+/**
+ * @brief Sends data to the threads blocked for reading and to the queue
+ * @param queue pointer to the queue, which must have room for the data
+ * @param data pointer to the data to be sent
+ * @param size size of the data in bytes
+ * @details While the queue is empty, the data for the blocked readers is copied
+ * straight into their buffers instead of through the queue memory. Data never
+ * bypasses data already in the queue, so the byte order is preserved. The rest
+ * is written to the queue.
+ */
+void
+queue_send( Queue_t* queue, const void* data, osCounter_t size )
+{
+	Thread_t* thread;
+	QueueReadWait_t* readWait;
+
+	OS_ASSERT( size <= queue_getFreeSize(queue) );
 
-	for( ; counter < size; counter++ )
+	while( (queue->read == queue->write) && (queue->readingThreads.first != NULL) )
 	{
-		( (osByte_t*) data )[counter] = queue->memory[queue->read];
+		thread = (Thread_t*)( queue->readingThreads.first->container );
+		readWait = (QueueReadWait_t*) thread->wait;
 
-		if( queue->read < queue->size - 1 )
-			queue->read++;
-		else
-			queue->read = 0;
+		if( readWait->size > size )
+			break;
+
+		memcpy( readWait->data, data, readWait->size );
+		data = (const osByte_t*) data + readWait->size;
+		size -= readWait->size;
+
+		readWait->result = true;
+		thread_makeReady( thread );
 	}
+
+	if( size != 0 )
+		queue_write( queue, data, size );
 }
 
 /**
@@ -61,11 +122,19 @@ queue_read( Queue_t* queue, void* data, osCounter_t size )
 osCounter_t
 queue_getUsedSize( Queue_t* queue )
 {
+	/* the data at the read position is held by a receiver */
+	if( queue->acquired != 0 )
+		return 0;
+
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+	return ( queue->write - queue->read ) & ( queue->size - 1 );
+#else
 	if( queue->write >= queue->read )
 		return queue->write - queue->read;
 	else
 		/* (queue->size - 1) - ( queue->read - queue->write  - 1) */
 		return queue->size - queue->read + queue->write;
+#endif
 }
 
 /**
@@ -76,11 +145,39 @@ queue_getUsedSize( Queue_t* queue )
 osCounter_t
 queue_getFreeSize( Queue_t* queue )
 {
+	/* the space at the write position is held by a sender */
+	if( queue->reserved != 0 )
+		return 0;
+
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+	return ( queue->read - queue->write - 1 ) & ( queue->size - 1 );
+#else
 	if( queue->read > queue->write )
 		return queue->read - queue->write - 1;
 	else
 		/* (queue->size - 1) - ( queue->write - queue->read ) */
 		return queue->size - 1 - queue->write + queue->read;
+#endif
+}
+
+/**
+ * @brief Describes a region of the queue memory
+ * @param queue pointer to the queue
+ * @param position the position in the queue memory where the region starts
+ * @param size size of the region in bytes
+ * @param region pointer to the region description to be filled in
+ */
+void
+queue_getRegion( Queue_t* queue, osCounter_t position, osCounter_t size, osQueueRegion_t* region )
+{
+	region->first = &queue->memory[position];
+	region->firstSize = queue->size - position;
+
+	if( region->firstSize > size )
+		region->firstSize = size;
+
+	region->second = queue->memory;
+	region->secondSize = size - region->firstSize;
 }
 
 /**
@@ -114,7 +211,7 @@ queue_solveEquation( Queue_t* p )
 
 				if( writeWait->size <= queue_getFreeSize(p) )
 				{
-					queue_write( p, writeWait->data, writeWait->size );
+					queue_send( p, writeWait->data, writeWait->size );
 					writeWait->result = true;
 					thread_makeReady(thread);
 					canRead = true;
@@ -149,11 +246,12 @@ queue_solveEquation( Queue_t* p )
 
 	} // while( canRead || canWrite );
 
-	if( threads_ready.first->value < currentThread->priority )
-	{
-		thread_setNew();
-		port_yield();
-	}
+	/* data left after serving the blocked readers */
+	if( queue_getUsedSize(p) != 0 )
+		waitAny_notify( &p->selectors );
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
 }
 
 /**
@@ -162,7 +260,8 @@ queue_solveEquation( Queue_t* p )
  * @return handle to the queue, if the queue is created successfully;
  * 0, if the creation failed.
  * @details The actual memory allocated to the queue might be larger than
- * requested due to alignment requirements in the heap.
+ * requested due to alignment requirements in the heap, or due to rounding
+ * up to a power of two if @ref OS_QUEUE_SIZE_POWER_OF_TWO is enabled.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- Yes: main stack context before the kernel started
@@ -174,6 +273,9 @@ osQueueCreate( osCounter_t size )
 {
 	Queue_t* queue;
 	osByte_t* memory;
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+	osCounter_t powerOfTwo = 1;
+#endif
 
 	osThreadEnterCritical();
 	queue = memory_allocateFromHeap( sizeof(Queue_t), &kernelMemoryList );
@@ -187,6 +289,14 @@ osQueueCreate( osCounter_t size )
 
 	OS_ASSERT( size >= 1 );
 
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+	/* the smallest power of two that holds size + 1 */
+	while( powerOfTwo < size + 1 )
+		powerOfTwo <<= 1;
+
+	size = powerOfTwo - 1;
+#endif
+
 	osThreadEnterCritical();
 	/* allocate size + 1 for the memory of the circular buffer */
 	memory = memory_allocateFromHeap( size + 1, &kernelMemoryList );
@@ -205,10 +315,18 @@ osQueueCreate( osCounter_t size )
 	queue->memory = memory;
 	queue->read = 0;
 	queue->write = 0;
+	queue->reserved = 0;
+	queue->acquired = 0;
+#if OS_QUEUE_SIZE_POWER_OF_TWO
+	/* the extra bytes due to heap alignment are not used */
+	queue->size = size + 1;
+#else
 	queue->size = osMemoryUsableSize(memory);
+#endif
 
 	prioritizedList_init( &queue->readingThreads );
 	prioritizedList_init( &queue->writingThreads );
+	notPrioritizedList_init( &queue->selectors );
 
 	return (osHandle_t) queue;
 }
@@ -235,15 +353,13 @@ osQueueDelete( osHandle_t h )
 	{
 		thread_makeAllReady( &queue->readingThreads );
 		thread_makeAllReady( &queue->writingThreads );
+		waitAny_notify( &queue->selectors );
 
 		memory_returnToHeap( queue->memory, & kernelMemoryList );
 		memory_returnToHeap( queue, & kernelMemoryList );
 
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
 	}
 	osThreadExitCritical();
 }
@@ -253,7 +369,7 @@ osQueueDelete( osHandle_t h )
  * @param h handle to the queue to be reset
  * @details This function resets the queue to the initial state right
  * after it was created. This can be used to clear the content in the
- * queue.
+ * queue. The queue must not have a reserved or acquired region.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- No: main stack context before the kernel started
@@ -268,6 +384,8 @@ osQueueReset( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
+		OS_ASSERT( (queue->reserved == 0) && (queue->acquired == 0) );
+
 		queue->read = 0;
 		queue->write = 0;
 		queue_solveEquation(queue);
@@ -430,7 +548,7 @@ osQueueSendNonBlock( osHandle_t h, const void* data, osCounter_t size )
 		if( size <= queue_getFreeSize(queue) )
 		{
 			result = true;
-			queue_write( queue, data, size );
+			queue_send( queue, data, size );
 			queue_solveEquation(queue);
 		}
 	}
@@ -501,7 +619,7 @@ osQueueSend( osHandle_t h, const void* data, osCounter_t size, osCounter_t timeo
 		if( size <= queue_getFreeSize(queue) )
 		{
 			result = true;
-			queue_write( queue, data, size );
+			queue_send( queue, data, size );
 			queue_solveEquation(queue);
 		}
 		else
@@ -543,7 +661,7 @@ osQueueReceive( osHandle_t h, void* data, osCounter_t size, osCounter_t timeout
 
 	osThreadEnterCritical();
 	{
-		if( queue_getFreeSize(queue) )
+		if( size <= queue_getUsedSize(queue) )
 		{
 			result = true;
 			queue_read( queue, data, size );
@@ -562,3 +680,142 @@ osQueueReceive( osHandle_t h, void* data, osCounter_t size, osCounter_t timeout
 
 	return result;
 }
+
+/**
+ * @brief Reserves space in the queue to be filled in place
+ * @param h handle to the queue
+ * @param size size in bytes of the data to be sent onto the queue
+ * @param region pointer to the region description to be filled in with the
+ * reserved space, which might wrap around the end of the queue memory
+ * @retval true if the space was reserved
+ * @retval false if there is not enough free space, or another region is reserved
+ * @details The data is written directly into the queue memory and sent by
+ * @ref osQueueSendCommit, saving the copy from a buffer of the sender.
+ * No other data can be sent onto the queue until the region is committed.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osQueueSendReserve( osHandle_t h, osCounter_t size, osQueueRegion_t* region )
+{
+	Queue_t* queue = (Queue_t*) h;
+	osBool_t result = false;
+
+	OS_ASSERT(h);
+	OS_ASSERT( size >= 1 );
+
+	osThreadEnterCritical();
+	{
+		if( size <= queue_getFreeSize(queue) )
+		{
+			result = true;
+			queue_getRegion( queue, queue->write, size, region );
+			queue->reserved = size;
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Sends the data written into a reserved region of the queue
+ * @param h handle to the queue
+ * @param size size in bytes of the data written, from the start of the region,
+ * up to the reserved size. 0 cancels the reservation.
+ * @details The threads waiting for reading from the queue are served.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osQueueSendCommit( osHandle_t h, osCounter_t size )
+{
+	Queue_t* queue = (Queue_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		OS_ASSERT( queue->reserved != 0 );
+		OS_ASSERT( size <= queue->reserved );
+
+		queue->write = QUEUE_WRAP( queue, queue->write + size );
+		queue->reserved = 0;
+		queue_solveEquation(queue);
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Acquires data in the queue to be consumed in place
+ * @param h handle to the queue
+ * @param size size in bytes of the data to be received from the queue
+ * @param region pointer to the region description to be filled in with the
+ * acquired data, which might wrap around the end of the queue memory
+ * @retval true if the data was acquired
+ * @retval false if there is not enough data, or other data is acquired
+ * @details The data is read directly from the queue memory and removed from
+ * the queue by @ref osQueueReceiveRelease, saving the copy into a buffer of the
+ * receiver. No other data can be received from the queue until the region is
+ * released.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osBool_t
+osQueueReceiveAcquire( osHandle_t h, osCounter_t size, osQueueRegion_t* region )
+{
+	Queue_t* queue = (Queue_t*) h;
+	osBool_t result = false;
+
+	OS_ASSERT(h);
+	OS_ASSERT( size >= 1 );
+
+	osThreadEnterCritical();
+	{
+		if( size <= queue_getUsedSize(queue) )
+		{
+			result = true;
+			queue_getRegion( queue, queue->read, size, region );
+			queue->acquired = size;
+		}
+	}
+	osThreadExitCritical();
+
+	return result;
+}
+
+/**
+ * @brief Removes the consumed data of an acquired region from the queue
+ * @param h handle to the queue
+ * @param size size in bytes of the data consumed, from the start of the region,
+ * up to the acquired size. 0 leaves all the data in the queue.
+ * @details The threads waiting for writing to the queue are served.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osQueueReceiveRelease( osHandle_t h, osCounter_t size )
+{
+	Queue_t* queue = (Queue_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		OS_ASSERT( queue->acquired != 0 );
+		OS_ASSERT( size <= queue->acquired );
+
+		queue->read = QUEUE_WRAP( queue, queue->read + size );
+		queue->acquired = 0;
+		queue_solveEquation(queue);
+	}
+	osThreadExitCritical();
+}
@@ -9,6 +9,33 @@
 #include "../includes/global.h"
 #include "../includes/functions.h"
 
+#if OS_USE_ATOMICS
+/**
+ * @brief Decrements the counter of a semaphore atomically
+ * @param semaphore pointer to the semaphore control block
+ * @retval true if the counter of the semaphore is decremented
+ * @retval false if the counter is zero or threads may be waiting
+ * @details The decrement is retried if the counter is changed by another
+ * context in the meantime. Interrupts are not disabled.
+ */
+osBool_t
+semaphore_tryDecrement( Semaphore_t* semaphore )
+{
+	osCounter_t counter;
+
+	for( ; ; )
+	{
+		counter = semaphore->counter;
+
+		if( (counter == 0) || (counter == SEMAPHORE_CONTENDED) )
+			return false;
+
+		if( OS_ATOMIC_CAS( &semaphore->counter, counter, counter - 1 ) )
+			return true;
+	}
+}
+#endif
+
 /**
  * @brief Creates a semaphore
  * @param initial the initial value of the semaphore counter
@@ -36,6 +63,7 @@ osSemaphoreCreate( osCounter_t initial )
 
 	semaphore->counter = initial;
 	prioritizedList_init( &semaphore->threads );
+	notPrioritizedList_init( &semaphore->selectors );
 
 	return (osHandle_t) semaphore;
 }
@@ -62,12 +90,10 @@ osSemaphoreDelete( osHandle_t h )
 	osThreadEnterCritical();
 	{
 		thread_makeAllReady( & semaphore->threads );
+		waitAny_notify( & semaphore->selectors );
 
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
 
 		memory_returnToHeap( semaphore, & kernelMemoryList );
 	}
@@ -115,11 +141,17 @@ osSemaphoreReset( osHandle_t h, osCounter_t initial )
 		/* the value left after unblocking all the waiting threads */
 		semaphore->counter = initial;
 
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		if( semaphore->counter != 0 )
+			waitAny_notify( & semaphore->selectors );
+
+#if OS_USE_ATOMICS
+		/* threads are still waiting */
+		if( (semaphore->threads.first != NULL) || (semaphore->selectors.first != NULL) )
+			semaphore->counter = SEMAPHORE_CONTENDED;
+#endif
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
 	}
 	osThreadExitCritical();
 }
@@ -143,7 +175,7 @@ osSemaphoreGetCounter( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		ret = semaphore->counter;
+		ret = SEMAPHORE_COUNT( semaphore );
 	}
 	osThreadExitCritical();
 	return ret;
@@ -154,7 +186,9 @@ osSemaphoreGetCounter( osHandle_t h )
  * @param h handle to the semaphore
  * @details This function will increment the counter of the semaphore
  * by one, and if threads are blocked for the semaphore, the thread with
- * the highest priority will be readied.
+ * the highest priority will be readied. If @ref OS_USE_ATOMICS is enabled
+ * and no thread is waiting, the counter is incremented atomically without
+ * disabling interrupts.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- No: main stack context before the kernel started
@@ -166,9 +200,28 @@ osSemaphorePost( osHandle_t h )
 	Semaphore_t* semaphore = (Semaphore_t*) h;
 	Thread_t* thread;
 	SemaphoreWait_t* wait;
+#if OS_USE_ATOMICS
+	osCounter_t counter;
+#endif
 
 	OS_ASSERT(h);
 
+#if OS_USE_ATOMICS
+	/* fast path, no thread is waiting. retry if the counter changed in the meantime */
+	for( ; ; )
+	{
+		counter = semaphore->counter;
+
+		if( counter == SEMAPHORE_CONTENDED )
+			break;
+
+		OS_ASSERT( counter + 1 != SEMAPHORE_CONTENDED );
+
+		if( OS_ATOMIC_CAS( &semaphore->counter, counter, counter + 1 ) )
+			return;
+	}
+#endif
+
 	osThreadEnterCritical();
 	{
 		/* check if any thread is waiting, transfer this value to the first
@@ -182,16 +235,14 @@ osSemaphorePost( osHandle_t h )
 			wait->result = true;
 			thread_makeReady( thread );
 
-			if( thread->priority < currentThread->priority )
-			{
-				thread_setNew();
-				port_yield();
-			}
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
 		}
 		else
 		{
 			/* no other threads are blocking. */
-			semaphore->counter++;
+			semaphore->counter = SEMAPHORE_COUNT( semaphore ) + 1;
+			waitAny_notify( & semaphore->selectors );
 		}
 	}
 	osThreadExitCritical();
@@ -221,7 +272,7 @@ osSemaphorePeekWait( osHandle_t h )
 
 	osThreadEnterCritical();
 	{
-		ret = semaphore->counter != 0;
+		ret = SEMAPHORE_COUNT( semaphore ) != 0;
 	}
 	osThreadExitCritical();
 
@@ -236,7 +287,8 @@ osSemaphorePeekWait( osHandle_t h )
  * @details Beware that another thread can modify the semaphore as
  * soon as this function returns. In order to prevent this, a critical section
  * should be used if some actions are to be performed based on the results of
- * this function.
+ * this function. If @ref OS_USE_ATOMICS is enabled, the counter is decremented
+ * atomically without disabling interrupts.
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
  * 	- Yes: main stack context before the kernel started
@@ -250,6 +302,9 @@ osSemaphoreWaitNonBlock( osHandle_t h )
 
 	OS_ASSERT(h);
 
+#if OS_USE_ATOMICS
+	result = semaphore_tryDecrement( semaphore );
+#else
 	osThreadEnterCritical();
 	{
 		if( semaphore->counter != 0 )
@@ -259,6 +314,7 @@ osSemaphoreWaitNonBlock( osHandle_t h )
 		}
 	}
 	osThreadExitCritical();
+#endif
 	return result;
 }
 
@@ -283,15 +339,25 @@ osSemaphoreWait( osHandle_t h, osCounter_t timeout )
 
 	OS_ASSERT(h);
 
+#if OS_USE_ATOMICS
+	/* fast path, the counter is not zero */
+	if( semaphore_tryDecrement( semaphore ) )
+		return true;
+#endif
+
 	osThreadEnterCritical();
 	{
-		if( semaphore->counter != 0 )
+		if( SEMAPHORE_COUNT( semaphore ) != 0 )
 		{
 			semaphore->counter--;
 			result = true;
 		}
 		else
 		{
+#if OS_USE_ATOMICS
+			/* make the atomic increments of concurrent posts fail */
+			semaphore->counter = SEMAPHORE_CONTENDED;
+#endif
 			wait.result = false;
 			thread_blockCurrent( & semaphore->threads, timeout, & wait );
 			result = wait.result;
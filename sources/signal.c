@@ -37,6 +37,7 @@ osSignalCreate( void )
 	}
 
 	prioritizedList_init( &signal->threadsOnSignal );
+	notPrioritizedList_init( &signal->selectors );
 	return (osHandle_t)( signal );
 }
 
@@ -62,12 +63,10 @@ osSignalDelete( osHandle_t h )
 	osThreadEnterCritical();
 	{
 		thread_makeAllReady( & signal->threadsOnSignal );
+		waitAny_notify( & signal->selectors );
 
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
 
 		/* release memory */
 		memory_returnToHeap( signal, & kernelMemoryList );
@@ -184,11 +183,11 @@ osSignalSend( osHandle_t h, osSignalValue_t signalValue, const void* info, osCou
 			} while( i != signal->threadsOnSignal.first );
 		}
 
-		if( threads_ready.first->value < currentThread->priority )
-		{
-			thread_setNew();
-			port_yield();
-		}
+		/* any signal value wakes the threads waiting for several objects */
+		waitAny_notify( & signal->selectors );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
 	}
 	osThreadExitCritical();
 }
@@ -0,0 +1,319 @@
+/** **************************************************************
+ * @file
+ * @brief Single-producer single-consumer ring implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of the single-producer
+ * single-consumer ring. One producer, usually an interrupt, streams bytes
+ * to one consumer thread. Data is moved with ordered loads and stores of the
+ * read and write positions only, the kernel is entered solely to wake the
+ * consumer blocked on an empty ring.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+#include <string.h>
+
+/**
+ * @brief Readies the consumer blocked on a ring
+ * @param ring pointer to the ring
+ */
+void
+spscRing_wakeConsumer( SpscRing_t* ring )
+{
+	Thread_t* thread;
+	SemaphoreWait_t* wait;
+
+	osThreadEnterCritical();
+	{
+		/* the consumer might have timed out in the meantime */
+		if( ring->readingThreads.first != NULL )
+		{
+			thread = (Thread_t*)( ring->readingThreads.first->container );
+			wait = (SemaphoreWait_t*) thread->wait;
+
+			wait->result = true;
+			thread_makeReady( thread );
+
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
+		}
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Creates a single-producer single-consumer ring
+ * @param size the number of bytes the ring can hold
+ * @return handle to the ring, if the ring is created successfully;
+ * 0, if the creation failed.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osSpscRingCreate( osCounter_t size )
+{
+	SpscRing_t* ring;
+	osByte_t* memory;
+
+	OS_ASSERT( size >= 1 );
+
+	osThreadEnterCritical();
+	ring = memory_allocateFromHeap( sizeof(SpscRing_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( ring == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	osThreadEnterCritical();
+	/* one byte is always left empty to tell a full ring from an empty one */
+	memory = memory_allocateFromHeap( size + 1, &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( memory == NULL )
+	{
+		osThreadEnterCritical();
+		memory_returnToHeap( ring, & kernelMemoryList );
+		osThreadExitCritical();
+
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	ring->memory = memory;
+	ring->size = size + 1;
+	ring->read = 0;
+	ring->write = 0;
+
+	prioritizedList_init( &ring->readingThreads );
+
+	return (osHandle_t) ring;
+}
+
+/**
+ * @brief Deletes a single-producer single-consumer ring
+ * @param h handle to the ring to be deleted
+ * @details The consumer blocked on the ring prior to its deletion will be
+ * readied and receive nothing. The handle should not be used again after
+ * calling this function.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osSpscRingDelete( osHandle_t h )
+{
+	SpscRing_t* ring = (SpscRing_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		thread_makeAllReady( &ring->readingThreads );
+
+		memory_returnToHeap( ring->memory, & kernelMemoryList );
+		memory_returnToHeap( ring, & kernelMemoryList );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Gets the number of bytes in the ring
+ * @param h handle to the ring
+ * @return the number of bytes in the ring
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osSpscRingGetUsedSize( osHandle_t h )
+{
+	SpscRing_t* ring = (SpscRing_t*) h;
+	osCounter_t read, write;
+
+	OS_ASSERT(h);
+
+	read = ring->read;
+	write = ring->write;
+
+	if( write >= read )
+		return write - read;
+	else
+		return ring->size - read + write;
+}
+
+/**
+ * @brief Writes as many bytes as fit into the ring
+ * @param h handle to the ring
+ * @param data pointer to the data to be written
+ * @param size size of the data in bytes
+ * @return the number of bytes written, which is less than size if the ring
+ * is full
+ * @details This function is wait-free. It must only be called by the single
+ * producer of the ring.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osSpscRingWrite( osHandle_t h, const void* data, osCounter_t size )
+{
+	SpscRing_t* ring = (SpscRing_t*) h;
+	osCounter_t read, write, free, first;
+
+	OS_ASSERT(h);
+
+	read = ring->read;
+	write = ring->write;
+
+	if( read > write )
+		free = read - write - 1;
+	else
+		free = ring->size - 1 - write + read;
+
+	if( size > free )
+		size = free;
+
+	first = ring->size - write;
+	if( first > size )
+		first = size;
+
+	memcpy( &ring->memory[write], data, first );
+
+	if( size > first )
+		memcpy( ring->memory, (const osByte_t*) data + first, size - first );
+
+	/* publish the data before the new write position (release) */
+	OS_MEMORY_BARRIER();
+
+	write += size;
+	if( write >= ring->size )
+		write -= ring->size;
+
+	ring->write = write;
+
+	/* the new write position has to be visible before the consumer is checked */
+	OS_MEMORY_BARRIER();
+
+	if( (size != 0) && (ring->readingThreads.first != NULL) )
+		spscRing_wakeConsumer( ring );
+
+	return size;
+}
+
+/**
+ * @brief Reads as many bytes as are available from the ring without blocking
+ * @param h handle to the ring
+ * @param data pointer to the buffer to hold the data
+ * @param size the maximum number of bytes to be read
+ * @return the number of bytes read
+ * @details This function is wait-free. It must only be called by the single
+ * consumer of the ring.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osSpscRingRead( osHandle_t h, void* data, osCounter_t size )
+{
+	SpscRing_t* ring = (SpscRing_t*) h;
+	osCounter_t read, write, used, first;
+
+	OS_ASSERT(h);
+
+	read = ring->read;
+	write = ring->write;
+
+	/* the data is only read after the write position (acquire) */
+	OS_MEMORY_BARRIER();
+
+	if( write >= read )
+		used = write - read;
+	else
+		used = ring->size - read + write;
+
+	if( size > used )
+		size = used;
+
+	first = ring->size - read;
+	if( first > size )
+		first = size;
+
+	memcpy( data, &ring->memory[read], first );
+
+	if( size > first )
+		memcpy( (osByte_t*) data + first, ring->memory, size - first );
+
+	/* the data has to be read before the space is handed back (release) */
+	OS_MEMORY_BARRIER();
+
+	read += size;
+	if( read >= ring->size )
+		read -= ring->size;
+
+	ring->read = read;
+
+	return size;
+}
+
+/**
+ * @brief Reads the bytes available in the ring, blocking while it is empty
+ * @param h handle to the ring
+ * @param data pointer to the buffer to hold the data
+ * @param size the maximum number of bytes to be read
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @return the number of bytes read, 0 if the wait timed out
+ * @details It must only be called by the single consumer of the ring.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osSpscRingReceive( osHandle_t h, void* data, osCounter_t size, osCounter_t timeout )
+{
+	SpscRing_t* ring = (SpscRing_t*) h;
+	SemaphoreWait_t wait;
+	osCounter_t result;
+
+	OS_ASSERT(h);
+	OS_ASSERT( size >= 1 );
+
+	for( ; ; )
+	{
+		result = osSpscRingRead( h, data, size );
+		if( result != 0 )
+			break;
+
+		osThreadEnterCritical();
+		{
+			/* the producer cannot run until the consumer is in the list, so
+			 * the data it writes afterwards always wakes the consumer */
+			wait.result = true;
+			if( ring->read == ring->write )
+			{
+				wait.result = false;
+				thread_blockCurrent( &ring->readingThreads, timeout, &wait );
+			}
+		}
+		osThreadExitCritical();
+
+		if( wait.result == false )
+			break;
+	}
+
+	return result;
+}
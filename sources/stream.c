@@ -0,0 +1,340 @@
+/** **************************************************************
+ * @file
+ * @brief Stream buffer implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of the stream buffer.
+ * A stream buffer is a queue whose readers receive whatever bytes have
+ * arrived, up to the size of their buffer. A blocked reader is only readied
+ * once the trigger level is reached, so that a writer producing a few bytes
+ * at a time does not wake it for each of them.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+/**
+ * @brief Hands the data in a stream buffer to the blocked readers
+ * @param stream pointer to the stream buffer
+ * @details A reader is served once the stream buffer holds the trigger level,
+ * or the size of its buffer if that is smaller.
+ */
+void
+stream_serveReaders( StreamBuffer_t* stream )
+{
+	Queue_t* queue = stream->queue;
+	Thread_t* thread;
+	QueueReadWait_t* readWait;
+	osCounter_t used, level;
+
+	while( queue->readingThreads.first != NULL )
+	{
+		thread = (Thread_t*)( queue->readingThreads.first->container );
+		readWait = (QueueReadWait_t*) thread->wait;
+
+		used = queue_getUsedSize( queue );
+
+		level = stream->triggerLevel;
+		if( level > readWait->size )
+			level = readWait->size;
+
+		if( (used == 0) || (used < level) )
+			break;
+
+		if( used > readWait->size )
+			used = readWait->size;
+
+		queue_read( queue, readWait->data, used );
+		readWait->size = used;
+		readWait->result = true;
+		thread_makeReady( thread );
+	}
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+
+/**
+ * @brief Creates a stream buffer
+ * @param size minimum number of bytes the stream buffer can hold
+ * @param triggerLevel number of bytes in the stream buffer at which a blocked
+ * reader is readied, at least 1
+ * @return handle to the stream buffer, if it is created successfully;
+ * 0, if the creation failed.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osHandle_t
+osStreamCreate( osCounter_t size, osCounter_t triggerLevel )
+{
+	StreamBuffer_t* stream;
+	osHandle_t queue;
+
+	OS_ASSERT( triggerLevel >= 1 );
+
+	osThreadEnterCritical();
+	stream = memory_allocateFromHeap( sizeof(StreamBuffer_t), &kernelMemoryList );
+	osThreadExitCritical();
+
+	if( stream == NULL )
+	{
+		OS_ASSERT(0);
+		return 0;
+	}
+
+	queue = osQueueCreate( size );
+
+	if( queue == 0 )
+	{
+		osThreadEnterCritical();
+		memory_returnToHeap( stream, & kernelMemoryList );
+		osThreadExitCritical();
+
+		return 0;
+	}
+
+	stream->queue = (Queue_t*) queue;
+	stream->triggerLevel = triggerLevel;
+
+	return (osHandle_t) stream;
+}
+
+/**
+ * @brief Deletes a stream buffer
+ * @param h handle to the stream buffer to be deleted
+ * @details The threads blocked on the stream buffer prior to its deletion will
+ * be readied and receive nothing, not even the bytes below the trigger level.
+ * The handle should not be used again after calling this function.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osStreamDelete( osHandle_t h )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+	Thread_t* thread;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		/* a size of 0 tells the readers apart from the ones that timed out,
+		 * since they must not touch the queue any more */
+		while( stream->queue->readingThreads.first != NULL )
+		{
+			thread = (Thread_t*)( stream->queue->readingThreads.first->container );
+			( (QueueReadWait_t*) thread->wait )->size = 0;
+			thread_makeReady( thread );
+		}
+
+		osQueueDelete( (osHandle_t) stream->queue );
+		memory_returnToHeap( stream, & kernelMemoryList );
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Discards all the data in a stream buffer
+ * @param h handle to the stream buffer
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osStreamReset( osHandle_t h )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		stream->queue->read = 0;
+		stream->queue->write = 0;
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Sets the trigger level of a stream buffer
+ * @param h handle to the stream buffer
+ * @param triggerLevel number of bytes in the stream buffer at which a blocked
+ * reader is readied, at least 1
+ * @details Blocked readers are served if the new trigger level is reached
+ * already.
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osStreamSetTriggerLevel( osHandle_t h, osCounter_t triggerLevel )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+
+	OS_ASSERT(h);
+	OS_ASSERT( triggerLevel >= 1 );
+
+	osThreadEnterCritical();
+	{
+		stream->triggerLevel = triggerLevel;
+		stream_serveReaders( stream );
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Gets the number of bytes in a stream buffer
+ * @param h handle to the stream buffer
+ * @return the number of bytes in the stream buffer
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osStreamGetUsedSize( osHandle_t h )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+
+	OS_ASSERT(h);
+
+	return osQueueGetUsedSize( (osHandle_t) stream->queue );
+}
+
+/**
+ * @brief Sends as many bytes as fit onto a stream buffer
+ * @param h handle to the stream buffer
+ * @param data pointer to the data to be sent
+ * @param size size of the data in bytes
+ * @return the number of bytes sent, which is less than size if the stream
+ * buffer is full
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osStreamSend( osHandle_t h, const void* data, osCounter_t size )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+	osCounter_t free;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		free = queue_getFreeSize( stream->queue );
+		if( size > free )
+			size = free;
+
+		if( size != 0 )
+		{
+			queue_write( stream->queue, data, size );
+			stream_serveReaders( stream );
+		}
+	}
+	osThreadExitCritical();
+
+	return size;
+}
+
+/**
+ * @brief Receives the bytes in a stream buffer without blocking
+ * @param h handle to the stream buffer
+ * @param data pointer to the buffer to hold the data
+ * @param maxLen the maximum number of bytes to be received
+ * @return the number of bytes received, 0 if the stream buffer is empty
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osStreamReceiveNonBlock( osHandle_t h, void* data, osCounter_t maxLen )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+	osCounter_t used;
+
+	OS_ASSERT(h);
+
+	osThreadEnterCritical();
+	{
+		used = queue_getUsedSize( stream->queue );
+		if( used > maxLen )
+			used = maxLen;
+
+		if( used != 0 )
+			queue_read( stream->queue, data, used );
+	}
+	osThreadExitCritical();
+
+	return used;
+}
+
+/**
+ * @brief Receives the bytes in a stream buffer
+ * @param h handle to the stream buffer
+ * @param data pointer to the buffer to hold the data
+ * @param maxLen the maximum number of bytes to be received
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @return the number of bytes received, 0 if nothing arrived before the wait
+ * timed out or the stream buffer was deleted
+ * @details If the stream buffer holds any data, up to maxLen bytes are
+ * received right away. Otherwise the thread blocks until the trigger level,
+ * or maxLen bytes if less, has arrived. If the wait times out first, the bytes
+ * that arrived below the trigger level are received, up to maxLen.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osStreamReceive( osHandle_t h, void* data, osCounter_t maxLen, osCounter_t timeout )
+{
+	StreamBuffer_t* stream = (StreamBuffer_t*) h;
+	QueueReadWait_t readWait;
+	osCounter_t used;
+
+	OS_ASSERT(h);
+	OS_ASSERT( maxLen >= 1 );
+
+	osThreadEnterCritical();
+	{
+		used = queue_getUsedSize( stream->queue );
+		if( used > maxLen )
+			used = maxLen;
+
+		if( used != 0 )
+			queue_read( stream->queue, data, used );
+		else
+		{
+			readWait.data = data;
+			readWait.result = false;
+			readWait.size = maxLen;
+			thread_blockCurrent( &stream->queue->readingThreads, timeout, &readWait );
+
+			if( readWait.result )
+				used = readWait.size;
+
+			/* timed out, the bytes below the trigger level are not left behind */
+			else if( readWait.size != 0 )
+			{
+				used = queue_getUsedSize( stream->queue );
+				if( used > maxLen )
+					used = maxLen;
+
+				if( used != 0 )
+					queue_read( stream->queue, data, used );
+			}
+		}
+	}
+	osThreadExitCritical();
+
+	return used;
+}
@@ -44,7 +44,31 @@ thread_init( Thread_t* thread )
 	notPrioritizedList_itemInit( &thread->schedulerListItem, thread );
 	prioritizedList_itemInit( &thread->timerListItem, thread, 0 );
 	memory_listInit( &thread->localMemory );
+	/* not in the ready queue until it is readied */
+	thread->state = OSTHREAD_SUSPENDED;
+	notPrioritizedList_init( &thread->heldMutexes );
+	thread->blockingMutex = NULL;
+	prioritizedList_init( &thread->replyingThreads );
+	thread->blockingServer = NULL;
+	thread->waitAny = NULL;
 	thread->wait = NULL;
+	thread->timeSlice = OS_TIME_SLICE_DEFAULT;
+	thread->timeSliceLeft = OS_TIME_SLICE_DEFAULT;
+	thread->timeSliceCounter = 0;
+#if OS_USE_EDF
+	thread->period = 0;
+	thread->relativeDeadline = 0;
+	thread->release = 0;
+	thread->absoluteDeadline = 0;
+	thread->deadlineMissCounter = 0;
+#endif
+#if OS_USE_CPU_BUDGET
+	prioritizedList_itemInit( &thread->budgetListItem, thread, 0 );
+	thread->budget = 0;
+	thread->budgetPeriod = 0;
+	thread->budgetLeft = 0;
+	thread->budgetOverrunCounter = 0;
+#endif
 }
 
 /**
@@ -61,9 +85,9 @@ thread_makeReady( Thread_t* thread )
 	/* this function has to be called in a critical section because it accesses global resources */
 	OS_ASSERT( criticalNesting );
 
-	/* the thread to be readied must not be in the ready list */
-	OS_ASSERT( currentThread->state != OSTHREAD_READY );
-	OS_ASSERT( thread->schedulerListItem.list != (void* )&threads_ready );
+	/* the thread to be readied must not be in the ready queue */
+	OS_ASSERT( thread->state != OSTHREAD_READY );
+	OS_ASSERT( !thread_isReady(thread) );
 
 	/* remove the schedulerListItem from some resource's waiting list, if any */
 	if( thread->schedulerListItem.list != NULL )
@@ -73,6 +97,18 @@ thread_makeReady( Thread_t* thread )
 		list_remove( &thread->schedulerListItem );
 	}
 
+	/* a thread that did not get the mutex it waited for gives back its priority to the owner */
+	if( thread->blockingMutex != NULL )
+		mutex_abandonWait( thread );
+
+	/* a thread that is no longer waiting for a reply gives back its priority to the server */
+	if( thread->blockingServer != NULL )
+		msg_abandonWait( thread );
+
+	/* a thread waiting for several objects leaves the lists of all of them */
+	if( thread->waitAny != NULL )
+		waitAny_abandon( thread );
+
 	/* If the thread was in a timed blocking, we also need to remove it from the system
 	 * timeout list. */
 	if( thread->timerListItem.list != NULL )
@@ -81,8 +117,9 @@ thread_makeReady( Thread_t* thread )
 	/* remove the docked wait struct. */
 	thread->wait = NULL;
 
-	/* insert the thread into the ready list, and set its state to ready */
-	prioritizedList_insert( (PrioritizedListItem_t*) ( &thread->schedulerListItem ), &threads_ready );
+	/* insert the thread into the ready queue with a full time slice, and set its state to ready */
+	thread_readyInsert( thread );
+	thread->timeSliceLeft = thread->timeSlice;
 	thread->state = OSTHREAD_READY;
 }
 
@@ -103,9 +140,6 @@ thread_makeAllReady( PrioritizedList_t* list )
 	/* this function has to be called in a critical section because it accesses global resources. */
 	OS_ASSERT( criticalNesting );
 
-	/* the list must not be the ready list */
-	OS_ASSERT( list != & threads_ready );
-
 	/* the loop will execute until the list is empty */
 	while( list->first != NULL )
 	{
@@ -145,21 +179,14 @@ thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait )
 
 	/* current thread is expected to be ready  */
 	OS_ASSERT( currentThread->state == OSTHREAD_READY );
-	OS_ASSERT( currentThread->schedulerListItem.list == (void* )( &threads_ready ) );
 
-	/* since currentThread is about to be removed from the ready list,
-	 * if nextThread is the same as currentThread (happens typically
-	 * after a context switch but before the next re-schedule), make sure
-	 * that nextThread stays in the ready list after removing currentThread */
-	if( currentThread == nextThread )
-	{
-		/* there's at least one thread (the idle thread) in the ready list */
-		nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
-	}
+	/* a thread cannot block while the scheduler is suspended */
+	OS_ASSERT( schedulerSuspendNesting == 0 );
+	OS_ASSERT( thread_isReady(currentThread) );
 
-	/* this will remove the list item from both prioritizedList and NotPrioritizedList,
-	 * whichever the item was in. */
-	list_remove( &currentThread->schedulerListItem );
+	/* remove current thread from the ready queue. nextThread might still point
+	 * to current thread, thread_setNew will move it back into the ready queue */
+	thread_readyRemove( currentThread );
 
 	/* change the state of the thread to blocked */
 	currentThread->state = OSTHREAD_BLOCKED;
@@ -168,15 +195,13 @@ thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait )
 	if( list != NULL )
 		prioritizedList_insert( (PrioritizedListItem_t*) &currentThread->schedulerListItem, list );
 
-	/* a finite timeout value, add to system timing list */
+	/* a finite timeout value, add to system timing wheel */
 	if( timeout != 0 )
 	{
-		/* calculate next time for next wake up. this even works if systemTime is about to overflow,
-		 * because the calculated time for next wake up overflows too */
-		currentThread->timerListItem.value = timeout + systemTime;
-
-		/* upon wake up, the timerListItem will be automatically removed from the list */
-		prioritizedList_insert( &currentThread->timerListItem, &threads_timed );
+		/* calculate next time for next wake up. this even works if the lower word of the system
+		 * time is about to overflow, because the wake up time is compared with wrap around.
+		 * upon wake up, the timerListItem will be automatically removed from the wheel */
+		timingWheel_insert( &threads_timed, &currentThread->timerListItem, timeout + TIME_NOW() );
 	}
 
 	/* dock the wait struct onto the thread control block */
@@ -194,20 +219,20 @@ thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait )
 	criticalNesting = 0;
 
 	/* open a window for the context switcher */
-	port_enableInterrupts();
+	CRITICAL_UNMASK_INTERRUPTS();
 	{
 		port_yield();
 
 		/* the thread resumes here */
 	}
-	port_disableInterrupts();
+	CRITICAL_MASK_INTERRUPTS();
 	
 	/* restore the critical nesting from the thread's stack */
 	OS_ASSERT( criticalNestingSave );
 	criticalNesting = criticalNestingSave;
 
-	/* the thread should be in the ready list when resumed from port_yield() */
-	OS_ASSERT( currentThread->schedulerListItem.list == (void* )( &threads_ready ) );
+	/* the thread should be in the ready queue when resumed from port_yield() */
+	OS_ASSERT( thread_isReady(currentThread) );
 
 	/* the thread should be in the ready state when resumed from port_yield */
 	OS_ASSERT( currentThread->state == OSTHREAD_READY );
@@ -216,6 +241,185 @@ thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait )
 	OS_ASSERT( currentThread->timerListItem.list == NULL );
 }
 
+/**
+ * @brief Readies the threads whose timeout has elapsed
+ * @param ticks the number of ticks @ref systemTime advanced since the last call
+ * @details This function readies the threads in the system timing wheel
+ * @ref threads_timed whose wake up time is not later than @ref systemTime.
+ * It is called after the system time advances, either by one tick in the tick
+ * handler or by a number of suppressed ticks after a tickless idle period.
+ * @note this function must be used in a critical section
+ */
+void
+thread_readyTimedOut( osCounter_t ticks )
+{
+	NotPrioritizedList_t expired;
+
+	/* this function has to be called in a critical section because it accesses
+	 * global resources. */
+	OS_ASSERT( criticalNesting );
+
+	notPrioritizedList_init( &expired );
+	timingWheel_takeExpired( &threads_timed, ticks, &expired );
+
+	/* thread_makeReady removes the timer list item from the expired list */
+	while( expired.first != NULL )
+		thread_makeReady( (Thread_t*) expired.first->container );
+}
+
+/**
+ * @brief Changes the priority of a thread in any state
+ * @param thread pointer to the thread control block
+ * @param priority the new priority of the thread
+ * @details The thread is moved to the position of its new priority in the ready
+ * queue or in the waiting list of a resource, whichever it is in. The caller
+ * decides whether a reschedule is needed.
+ * @note this function must be used in a critical section
+ */
+void
+thread_changePriority( Thread_t* thread, osCounter_t priority )
+{
+	PrioritizedList_t* list;
+
+	OS_ASSERT( criticalNesting );
+
+	list = (PrioritizedList_t*) ( thread->schedulerListItem.list );
+
+	/* move a ready thread to the ready list of its new priority level */
+	if( thread_isReady(thread) )
+	{
+		thread_readyRemove( thread );
+		thread->priority = priority;
+		thread_readyInsert( thread );
+	}
+
+	/* remove the schedulerListItem from its waiting list, if any */
+	else if( list != NULL )
+	{
+		/* this will remove the list item from both prioritizedList and NotPrioritizedList,
+		 * whichever the item was in. */
+		list_remove( &thread->schedulerListItem );
+
+		/* change the priority */
+		thread->priority = priority;
+
+		/* reinsert the schedulerListItem back to its list */
+		prioritizedList_insert( (PrioritizedListItem_t*) ( &thread->schedulerListItem ), list );
+	}
+	else
+		/* if the schedulerListItem is not in a list, change the value directly */
+		thread->priority = priority;
+}
+
+/**
+ * @brief Changes the priority a thread is given by the application
+ * @param thread pointer to the thread control block
+ * @param priority the new priority of the thread
+ * @details The preemption threshold is reset to the new priority. The thread keeps
+ * the priorities it inherited through its mutexes and its clients, and the change
+ * is passed on to the threads it waits for. The caller decides whether a
+ * reschedule is needed.
+ * @note this function must be used in a critical section
+ */
+void
+thread_setBasePriority( Thread_t* thread, osCounter_t priority )
+{
+	OS_ASSERT( criticalNesting );
+
+#if OS_USE_CPU_BUDGET
+	/* a thread that used up its budget keeps its background priority until
+	 * the budget is replenished */
+	if( thread->budget != 0 )
+	{
+		thread->budgetPriority = priority;
+
+		if( thread->budgetLeft == 0 )
+			priority = thread->basePriority;
+	}
+#endif
+
+	/* since changing priority takes a long time, but checking the priority does not,
+	 * check if the priority value is really different before performing the actions. */
+	if( priority != thread->basePriority )
+	{
+		/* the old threshold has no meaning at the new priority */
+		thread->preemptionThreshold = priority;
+		thread->basePriority = priority;
+
+		mutex_updatePriority( thread );
+	}
+}
+
+#if OS_USE_CPU_BUDGET
+/**
+ * @brief Charges one tick to the CPU budget of current thread
+ * @details The replenishment is scheduled one period after the thread starts to
+ * consume a full budget. Once the budget is used up, the thread drops to its
+ * background priority until then.
+ * @note this function must be used in a critical section
+ */
+void
+thread_chargeBudget( void )
+{
+	Thread_t* p = currentThread;
+
+	OS_ASSERT( criticalNesting );
+
+	/* no budget, or already running in the background */
+	if( (p->budget == 0) || (p->budgetLeft == 0) )
+		return;
+
+	if( p->budgetListItem.list == NULL )
+		timingWheel_insert( &budgets_timed, &p->budgetListItem, TIME_NOW() - 1 + p->budgetPeriod );
+
+	p->budgetLeft--;
+
+	if( p->budgetLeft == 0 )
+	{
+		p->budgetOverrunCounter++;
+		p->preemptionThreshold = p->backgroundPriority;
+		p->basePriority = p->backgroundPriority;
+		mutex_updatePriority( p );
+	}
+}
+
+/**
+ * @brief Replenishes the CPU budgets whose replenishment time has come
+ * @param ticks the number of ticks @ref systemTime advanced since the last call
+ * @details Threads that used up their budget are raised back to their priority.
+ * @note this function must be used in a critical section
+ */
+void
+thread_replenishBudgets( osCounter_t ticks )
+{
+	NotPrioritizedList_t expired;
+	Thread_t* p;
+
+	OS_ASSERT( criticalNesting );
+
+	notPrioritizedList_init( &expired );
+	timingWheel_takeExpired( &budgets_timed, ticks, &expired );
+
+	while( expired.first != NULL )
+	{
+		p = (Thread_t*) expired.first->container;
+		list_remove( &p->budgetListItem );
+
+		if( p->budgetLeft == 0 )
+		{
+			p->preemptionThreshold = p->budgetPriority;
+			p->basePriority = p->budgetPriority;
+			mutex_updatePriority( p );
+		}
+
+		p->budgetLeft = p->budget;
+	}
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+#endif
+
 /**
  * @brief Enters a critical section
  * @details This function is used to enter a critical section where interrupts
@@ -224,6 +428,10 @@ thread_blockCurrent( PrioritizedList_t* list, osCounter_t timeout, void* wait )
  * @ref osThreadExitCritical must be called for equal amount of times as
  * this function.
  *
+ * If @ref OS_USE_INTERRUPT_CEILING is enabled, only the interrupts up to
+ * @ref OS_KERNEL_INTERRUPT_CEILING are masked. Interrupts above the ceiling
+ * must not call this function, or any other kernel function.
+ *
  * @see osThreadExitCritical
  *
  * @note contexts in which this function can be used
@@ -235,10 +443,28 @@ void
 osThreadEnterCritical( void )
 {
 	/* enter critical section before accessing global resource 'criticalNesting' */
-	port_disableInterrupts();
+	CRITICAL_MASK_INTERRUPTS();
 	criticalNesting++;
 }
 
+/**
+ * @brief Performs a pending reschedule
+ * @details Clears the pending request, selects the next thread and yields if it is
+ * different from current thread.
+ * @note this function must be used in a critical section.
+ */
+void
+thread_reschedule( void )
+{
+	OS_ASSERT( criticalNesting );
+
+	reschedulePending = false;
+
+	thread_setNew();
+	if( currentThread != nextThread )
+		port_yield();
+}
+
 /**
  * @brief Exits a critical section
  * @details This function is used to exit a critical section where interrupts
@@ -247,6 +473,10 @@ osThreadEnterCritical( void )
  * @ref osThreadEnterCritical must be called for equal amount of times as
  * this function.
  *
+ * Threads readied inside the critical section only request a reschedule. The
+ * request is performed once, when the outermost critical section exits outside
+ * of interrupt handlers.
+ *
  * @see osThreadEnterCritical
  *
  * @note contexts in which this function can be used
@@ -262,8 +492,14 @@ osThreadExitCritical( void )
 
 	else if( criticalNesting == 1 )
 	{
+		/* perform the reschedule requested inside the critical section, unless an
+		 * interrupt handler is running, in which case @ref osInterruptExit does it,
+		 * or the scheduler is suspended, in which case @ref osSchedulerResume does it */
+		if( reschedulePending && (interruptNesting == 0) && (schedulerSuspendNesting == 0) )
+			thread_reschedule();
+
 		criticalNesting = 0;
-		port_enableInterrupts();
+		CRITICAL_UNMASK_INTERRUPTS();
 	}
 	else
 	{
@@ -271,6 +507,60 @@ osThreadExitCritical( void )
 	}
 }
 
+/**
+ * @brief Suspends the scheduler
+ * @details While the scheduler is suspended, no context switch happens, but interrupts
+ * stay enabled and interrupt handlers can still call the kernel. Threads readied in the
+ * meantime are scheduled when the scheduler resumes. This is used instead of a critical
+ * section to protect long operations on data that interrupt handlers never access.
+ * It supports nesting, which means @ref osSchedulerResume must be called for equal
+ * amount of times as this function.
+ *
+ * Current thread must not block, yield or suspend itself while the scheduler is
+ * suspended.
+ *
+ * @see osSchedulerResume
+ *
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osSchedulerSuspend( void )
+{
+	osThreadEnterCritical();
+	{
+		schedulerSuspendNesting++;
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Resumes the scheduler
+ * @details The reschedule requested while the scheduler was suspended, if any, is
+ * performed when the outermost suspension ends.
+ *
+ * @see osSchedulerSuspend
+ *
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osSchedulerResume( void )
+{
+	osThreadEnterCritical();
+	{
+		OS_ASSERT( schedulerSuspendNesting );
+		schedulerSuspendNesting--;
+
+		/* the pending reschedule, if any, is performed when the critical section exits */
+	}
+	osThreadExitCritical();
+}
+
 /**
  * @brief Externally changes the critical section nesting counter
  * @param counter the new critical section nesting counter
@@ -288,11 +578,11 @@ void
 osThreadSetCriticalNesting( osCounter_t counter )
 {
 	/* enter critical section before modifying critical nesting counter */
-	port_disableInterrupts();
+	CRITICAL_MASK_INTERRUPTS();
 	criticalNesting = counter;
 
 	if( counter == 0 )
-		port_enableInterrupts();
+		CRITICAL_UNMASK_INTERRUPTS();
 }
 
 /**
@@ -313,18 +603,19 @@ osThreadGetCriticalNesting( void )
 	osCounter_t ret;
 
 	/* enter critical section before reading critical nesting counter */
-	port_disableInterrupts();
+	CRITICAL_MASK_INTERRUPTS();
 	ret = criticalNesting;
 
 	if( ret == 0 )
-		port_disableInterrupts();
+		CRITICAL_MASK_INTERRUPTS();
 
 	return ret;
 }
 
 /**
  * @brief Creates a thread
- * @param priority the priority of the thread to be created
+ * @param priority the priority of the thread to be created, other than
+ * @ref OS_EDF_PRIORITY if @ref OS_USE_EDF is enabled
  * @param code the code (a function pointer casted to osCode_t) of the thread
  * @param stackSize the stack size of the thread
  * @param argument the argument to pass to the thread
@@ -361,6 +652,11 @@ osThreadCreate( osCounter_t priority, osCode_t code, osCounter_t stackSize, cons
 	Thread_t* thread;
 	osByte_t* stackMemory;
 
+#if OS_USE_EDF
+	/* the EDF priority is reserved for the threads given a deadline */
+	OS_ASSERT( priority != OS_EDF_PRIORITY );
+#endif
+
 	/* allocate a thread control block, put it into kernel memory list */
 	/* the function is thread safe */
 	osThreadEnterCritical();
@@ -401,6 +697,8 @@ osThreadCreate( osCounter_t priority, osCode_t code, osCounter_t stackSize, cons
 	 * into the CPU by the context switcher */
 	thread->PSP = port_makeFakeContext( stackMemory, stackSize, code, argument );
 	thread->priority = priority;
+	thread->basePriority = priority;
+	thread->preemptionThreshold = priority;
 	thread->stackMemory = stackMemory;
 
 	/* a critical section is necessary since the function modifies global structures */
@@ -443,7 +741,8 @@ osThreadGetState( osHandle_t h )
  * current thread.
  * @details Threads in all states can be deleted by calling this function.
  * The unfreed memory allocated my calling @ref osMemoryAllocate
- * during the life time of the thread will automatically be released. After
+ * during the life time of the thread will automatically be released, with the
+ * scheduler suspended rather than with interrupts disabled. After
  * calling this function, the handle will be invalid and should not be used
  * again.
  *
@@ -466,27 +765,60 @@ osThreadDelete( osHandle_t h )
 	osThreadEnterCritical();
 	{
 		/* remove the scheduler list item from its list, if any */
-		if( p->schedulerListItem.list != NULL )
-		{
-			/* if nextThread is the same as currentThread (happens typically
-			 * after a context switch but before the next re-schedule), make sure
-			 * that nextThread stays in the ready list after removing currentThread */
-			if( p == nextThread )
-				/* there's at least one thread (the idle thread) in the ready list */
-				nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
+		if( thread_isReady(p) )
+			thread_readyRemove( p );
 
+		else if( p->schedulerListItem.list != NULL )
 			/* this will remove the list item from both prioritizedList and NotPrioritizedList,
 			 * whichever the schedulerListItem is in. */
 			list_remove( &p->schedulerListItem );
-		}
+
+		/* stop waiting for a mutex, and pass the owned mutexes on to their waiting threads */
+		if( p->blockingMutex != NULL )
+			mutex_abandonWait( p );
+
+		mutex_releaseAll( p );
+
+		/* stop waiting for a reply, and fail the clients waiting for a reply from the thread */
+		if( p->blockingServer != NULL )
+			msg_abandonWait( p );
+
+		thread_makeAllReady( &p->replyingThreads );
+
+		/* stop waiting for several objects */
+		if( p->waitAny != NULL )
+			waitAny_abandon( p );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+
+		/* make sure that nextThread stays in the ready queue after removing the thread,
+		 * which happens typically after a context switch but before the next re-schedule */
+		if( p == nextThread )
+			thread_setNew();
 
 		/* remove the scheduler from the timing list, if it is in the list  */
 		if( p->timerListItem.list != NULL )
 			list_remove( &p->timerListItem );
 
+#if OS_USE_CPU_BUDGET
+		/* remove the pending budget replenishment, if any */
+		if( p->budgetListItem.list != NULL )
+			list_remove( &p->budgetListItem );
+#endif
 
-		/* Free all unfreed memory blocks allocated when osMemoryAllocate was called */
-		while( p->localMemory.first != NULL )
+		/* suspend the scheduler while the local memory is freed, so that current thread
+		 * keeps running even if it is the one being deleted */
+		schedulerSuspendNesting++;
+	}
+	osThreadExitCritical();
+
+	/* Free all unfreed memory blocks allocated when osMemoryAllocate was called.
+	 * The thread can no longer run and interrupts never access its memory list, so
+	 * the interrupts are only disabled while each block is returned to the heap */
+	while( p->localMemory.first != NULL )
+	{
+		osThreadEnterCritical();
 		{
 			/* point to a memory block */
 			block = p->localMemory.first;
@@ -494,22 +826,33 @@ osThreadDelete( osHandle_t h )
 			memory_blockRemoveFromMemoryList( block, & p->localMemory );
 			memory_returnBlockToHeap( block );
 		}
+		osThreadExitCritical();
+	}
 
-		/* after this, if deleting current thread, the context switcher will still try
-		 * to a stack frame data onto the thread's stack which is located in
-		 * kernelMemoryList at the moment. If a stack overflow occurs at that stage,
-		 * the kernelMemoryList can still be corrupted */
-		memory_returnToHeap( p->stackMemory, & kernelMemoryList );
-		memory_returnToHeap( p, & kernelMemoryList );
+	osThreadEnterCritical();
+	{
+		/* resume the scheduler, the reschedule requested in the meantime is performed
+		 * when the critical section exits */
+		schedulerSuspendNesting--;
 
-		/* load another thread if deleting current thread */
+		/* load another thread if deleting current thread. The next thread is selected
+		 * before the control block is freed, since thread_setNew reads current thread */
 		if( p == currentThread )
 		{
 			/* current thread is no longer in the ready list, thus out of consideration
-			 * by the scheduling function. */
+			 * by the scheduling function. A pending reschedule is done here, so that
+			 * exiting the critical section does not read current thread again */
+			reschedulePending = false;
 			thread_setNew();
 			port_yield();
 		}
+
+		/* after this, if deleting current thread, the context switcher will still try
+		 * to a stack frame data onto the thread's stack which is located in
+		 * kernelMemoryList at the moment. If a stack overflow occurs at that stage,
+		 * the kernelMemoryList can still be corrupted */
+		memory_returnToHeap( p->stackMemory, & kernelMemoryList );
+		memory_returnToHeap( p, & kernelMemoryList );
 	}
 	osThreadExitCritical();
 }
@@ -550,19 +893,30 @@ osThreadSuspend( osHandle_t h )
 		if( p->state != OSTHREAD_SUSPENDED )
 		{
 			/* remove the scheduler list item from its list, if any */
-			if( p->schedulerListItem.list != NULL )
-			{
-				/* if nextThread is the same as currentThread (happens typically
-				 * after a context switch but before the next re-schedule), make sure
-				 * that nextThread stays in the ready list after removing currentThread */
-				if( p == nextThread )
-					/* there's at least one thread (the idle thread) in the ready list */
-					nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
+			if( thread_isReady(p) )
+				thread_readyRemove( p );
 
+			else if( p->schedulerListItem.list != NULL )
 				/* this will remove the list item from both prioritizedList and NotPrioritizedList,
 				 * whichever the schedulerListItem was in. */
 				list_remove( &p->schedulerListItem );
-			}
+
+			/* the owner of the mutex waited for no longer inherits the priority of the thread */
+			if( p->blockingMutex != NULL )
+				mutex_abandonWait( p );
+
+			/* the server replying to the thread no longer inherits its priority */
+			if( p->blockingServer != NULL )
+				msg_abandonWait( p );
+
+			/* stop waiting for several objects */
+			if( p->waitAny != NULL )
+				waitAny_abandon( p );
+
+			/* make sure that nextThread stays in the ready queue after removing the thread,
+			 * which happens typically after a context switch but before the next re-schedule */
+			if( p == nextThread )
+				thread_setNew();
 
 			/* change the state of the thread */
 			p->state = OSTHREAD_SUSPENDED;
@@ -577,6 +931,9 @@ osThreadSuspend( osHandle_t h )
 			/* only needs to yield when suspending current thread */
 			if( p == currentThread )
 			{
+				/* a thread cannot suspend itself while the scheduler is suspended */
+				OS_ASSERT( schedulerSuspendNesting == 0 );
+
 				thread_setNew();
 				OS_ASSERT( currentThread != nextThread );
 
@@ -592,13 +949,13 @@ osThreadSuspend( osHandle_t h )
 				criticalNesting = 0;
 
 				/* open an interrupt-enabled window for the context switcher */
-				port_enableInterrupts();
+				CRITICAL_UNMASK_INTERRUPTS();
 				{
 					port_yield();
 
 					/* the thread resumes here if osThreadResume is called */
 				}
-				port_disableInterrupts();
+				CRITICAL_MASK_INTERRUPTS();
 
 				/* restore the critical nesting counter to system global space */
 				criticalNesting = criticalNestingSave;
@@ -636,12 +993,9 @@ osThreadResume( osHandle_t h )
 			/* ready this thread */
 			thread_makeReady( p );
 
-			/* yield immediately if the newly readied thread has a higher priority */
-			if( p->priority < currentThread->priority )
-			{
-				thread_setNew();
-				port_yield();
-			}
+			/* reschedule if the newly readied thread has a higher priority */
+			if( thread_isPreemptionNeeded() )
+				thread_requestReschedule();
 		}
 	}
 	osThreadExitCritical();
@@ -683,9 +1037,13 @@ osThreadGetPriority( osHandle_t h )
  * @brief Changes the priority of a thread
  * @param h the handle to the thread whose priority is to be changed, 0 can
  * be passed if changing the priority of current thread
- * @param priority the new priority of the thread
+ * @param priority the new priority of the thread, other than @ref OS_EDF_PRIORITY
+ * if @ref OS_USE_EDF is enabled
  * @details A reschedule will happen immediately after the priority modification
- * if the new priority is the highest priority in the system.
+ * if the new priority is the highest priority in the system. The preemption
+ * threshold of the thread is reset to the new priority. While the thread owns
+ * mutexes, it keeps running at the priority of the highest priority thread
+ * waiting for them, if that is higher.
  *
  * @note contexts in which this function can be used
  * 	- Yes: an interrupt context
@@ -695,45 +1053,100 @@ void
 osThreadSetPriority( osHandle_t h, osCounter_t priority )
 {
 	Thread_t* p = (Thread_t*) h;
-	PrioritizedList_t* list;
+
+#if OS_USE_EDF
+	/* the EDF priority is reserved for the threads given a deadline */
+	OS_ASSERT( priority != OS_EDF_PRIORITY );
+#endif
 
 	if( h == 0 )
 		p = currentThread;
 
 	osThreadEnterCritical();
 	{
-		/* since changing priority takes a long time, but checking the priority does not,
-		 * check if the priority value is really different before performing the actions. */
-		if( priority != p->priority )
-		{
-			list = (PrioritizedList_t*) ( p->schedulerListItem.list );
+		thread_setBasePriority( p, priority );
 
-			/* remove the schedulerListItem from its list, if any */
-			if( list != NULL )
-			{
-				/* this will remove the list item from both prioritizedList and NotPrioritizedList,
-				 * whichever the item was in. */
-				list_remove( &p->schedulerListItem );
+		/* re-schedule if current thread is no longer the one to run */
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
 
-				/* change the priority */
-				p->priority = priority;
+/**
+ * @brief Changes the preemption threshold of a thread
+ * @param h the handle to the thread, 0 can be passed if changing the preemption
+ * threshold of current thread
+ * @param threshold the new preemption threshold, which must not be lower (numerically
+ * greater) than the priority of the thread. Pass the priority of the thread to
+ * disable the threshold.
+ * @return the previous preemption threshold of the thread
+ * @details While the thread runs, only threads with a priority higher than the
+ * threshold can preempt it. Threads with priorities between the threshold and the
+ * priority of the thread have to wait until it blocks, which saves the context
+ * switches among a group of cooperating threads, and lets the group share data
+ * without mutexes as long as every member runs with the threshold of the group.
+ *
+ * A thread with a threshold above its priority is not rotated by round-robin
+ * scheduling. Threads are created with the threshold disabled, and it is reset by
+ * @ref osThreadSetPriority.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadSetPreemptionThreshold( osHandle_t h, osCounter_t threshold )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
 
-				/* reinsert the schedulerListItem back to its list */
-				prioritizedList_insert( (PrioritizedListItem_t*) ( &p->schedulerListItem ), list );
-			}
-			else
-				/* if the schedulerListItem is not in a list, change the value directly */
-				p->priority = priority;
+	if( h == 0 )
+		p = currentThread;
 
-			/* re-schedule immediately if higher priority is set */
-			if( priority < currentThread->priority )
-			{
-				thread_setNew();
-				port_yield();
-			}
-		}
+	osThreadEnterCritical();
+	{
+		OS_ASSERT( threshold <= p->basePriority );
+
+		ret = p->preemptionThreshold;
+		p->preemptionThreshold = threshold;
+
+		/* lowering the threshold of current thread may allow a preemption */
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+
+/**
+ * @brief Returns the preemption threshold of a thread
+ * @param h handle to the thread, 0 can be passed to check current thread
+ * @return the preemption threshold of the thread
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadGetPreemptionThreshold( osHandle_t h )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		ret = p->preemptionThreshold;
 	}
 	osThreadExitCritical();
+
+	return ret;
 }
 
 /**
@@ -787,7 +1200,7 @@ osThreadDelay( osCounter_t timeout )
 {
 	/* the thread have to be in a ready state to block */
 	OS_ASSERT( currentThread->state == OSTHREAD_READY );
-	OS_ASSERT( currentThread->schedulerListItem.list == (void* )( &threads_ready ) );
+	OS_ASSERT( thread_isReady(currentThread) );
 
 	osThreadEnterCritical();
 	{
@@ -820,30 +1233,34 @@ osThreadDelay( osCounter_t timeout )
 void
 osThreadYield( void )
 {
+	/* a thread cannot yield while the scheduler is suspended */
+	OS_ASSERT( schedulerSuspendNesting == 0 );
+
 	osThreadEnterCritical();
 	{
 		/* Perform round-robin scheduling
 		 *
-		 * The kernel allows multiple threads with same priority. All ready threads
-		 * with the highest priority are organized at the front of threads_ready, and CPU]
+		 * The kernel allows multiple threads with same priority. Ready threads with
+		 * the same priority are kept in a circular list in the ready queue, and CPU
 		 * time will be shared among them.
 		 *
-		 * set the nextThread pointer to the next thread after current thread,
-		 * and call thread_setNew to re-schedule. Since thread_setNew will automatically
-		 * check the priority of nextThread, nextThread will be set back to the
-		 * beginning of the list if its priority is no longer the highest.
+		 * set the nextThread pointer to the next thread after current thread in
+		 * its priority level, and call thread_setNew to re-schedule. Since
+		 * thread_setNew will automatically check the priority of nextThread,
+		 * nextThread will be set to the highest priority level if its priority
+		 * is no longer the highest. Both steps take constant time.
 		 */
 
-		/* next thread have to be in the ready list */
-		OS_ASSERT( nextThread->schedulerListItem.list == (void*)(&threads_ready) );
+		/* next thread have to be in the ready queue */
+		OS_ASSERT( thread_isReady(nextThread) );
+
+		/* a voluntary yield starts a new time slice for current thread */
+		currentThread->timeSliceLeft = currentThread->timeSlice;
 
 		/* move nextThread to the next item, and call the scheduler function to check if
 		 * it should be run next. */
 		nextThread = (Thread_t*)( nextThread->schedulerListItem.next->container );
 
-		/* next thread have to be in the ready list */
-		OS_ASSERT( nextThread->schedulerListItem.list == (void*)(&threads_ready) );
-
 		thread_setNew();
 
 		/* send yield request if scheduling gives a different thread */
@@ -853,3 +1270,319 @@ osThreadYield( void )
 	osThreadExitCritical();
 }
 
+/**
+ * @brief Sets the round-robin time slice of a thread
+ * @param h handle to the thread, 0 can be passed to set the time slice of
+ * current thread
+ * @param ticks the number of ticks the thread runs before it is rotated behind
+ * the other ready threads of the same priority. 0 can be passed if the thread
+ * should only give up the CPU by blocking or calling @ref osThreadYield.
+ * @details Threads are created with a time slice of @ref OS_TIME_SLICE_DEFAULT
+ * ticks. The new time slice starts immediately.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osThreadSetTimeSlice( osHandle_t h, osCounter_t ticks )
+{
+	Thread_t* p = (Thread_t*) h;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		p->timeSlice = ticks;
+		p->timeSliceLeft = ticks;
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Returns the round-robin time slice of a thread
+ * @param h handle to the thread, 0 can be passed to check current thread
+ * @return the time slice of the thread in ticks, 0 if the thread is never rotated
+ * by the tick
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadGetTimeSlice( osHandle_t h )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		ret = p->timeSlice;
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+
+/**
+ * @brief Returns the number of time slices a thread has used up
+ * @param h handle to the thread, 0 can be passed to check current thread
+ * @return the number of times the thread ran for a full time slice, each of which
+ * rotated it behind the other ready threads of the same priority
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadGetTimeSliceCounter( osHandle_t h )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		ret = p->timeSliceCounter;
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+
+
+#if OS_USE_EDF
+/**
+ * @brief Makes a thread an earliest-deadline-first thread
+ * @param h handle to the thread, 0 can be passed to change current thread
+ * @param deadline the relative deadline in ticks, measured from the start of
+ * each period
+ * @param period the non-zero period of the thread in ticks
+ * @details The thread is moved to priority @ref OS_EDF_PRIORITY, where ready threads
+ * are ordered by their absolute deadline, and the first period starts now. A higher
+ * priority inherited through mutexes is kept until it is given back, and the preemption
+ * threshold is reset, as with @ref osThreadSetPriority. The thread is never rotated by
+ * the tick handler. At the end of the work of each period, the
+ * thread should call @ref osThreadWaitNextPeriod.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osThreadSetDeadline( osHandle_t h, osCounter_t deadline, osCounter_t period )
+{
+	Thread_t* p = (Thread_t*) h;
+	osBool_t ready;
+
+	OS_ASSERT( period != 0 );
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		/* take the thread out of the ready queue while its deadline changes */
+		ready = thread_isReady(p);
+		if( ready )
+			thread_readyRemove( p );
+
+		p->relativeDeadline = deadline;
+		p->period = period;
+		p->release = TIME_NOW();
+		p->absoluteDeadline = p->release + deadline;
+		p->deadlineMissCounter = 0;
+		p->timeSlice = 0;
+		p->timeSliceLeft = 0;
+
+		if( ready )
+			thread_readyInsert( p );
+
+		/* the thread keeps the priorities it inherited, and the threads it waits
+		 * for are updated, as with any other priority change */
+		thread_setBasePriority( p, OS_EDF_PRIORITY );
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Ends the work of the current period of an EDF thread
+ * @details If the thread completes after the absolute deadline of the period,
+ * its deadline miss counter is incremented. The thread then blocks until the
+ * start of its next period, and its absolute deadline moves to the next period.
+ * If the next period has already started, the thread keeps running with the
+ * new deadline, and may be preempted by an EDF thread with an earlier deadline.
+ *
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osThreadWaitNextPeriod( void )
+{
+	Thread_t* p = currentThread;
+
+	/* only EDF threads have periods */
+	OS_ASSERT( p->period != 0 );
+
+	osThreadEnterCritical();
+	{
+		/* completed later than the deadline */
+		if( !TIME_IS_REACHED( TIME_NOW(), p->absoluteDeadline ) )
+			p->deadlineMissCounter++;
+
+		/* the thread leaves the sorted ready list before its deadline changes */
+		thread_readyRemove( p );
+
+		p->release += p->period;
+		p->absoluteDeadline = p->release + p->relativeDeadline;
+
+		thread_readyInsert( p );
+
+		if( !TIME_IS_REACHED( p->release, TIME_NOW() ) )
+		{
+			/* wait until the next period starts */
+			thread_blockCurrent( NULL, p->release - TIME_NOW(), NULL );
+		}
+		else if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Returns the number of deadline misses of an EDF thread
+ * @param h handle to the thread, 0 can be passed to check current thread
+ * @return the number of periods the thread completed after their deadline
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadGetDeadlineMissCounter( osHandle_t h )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		ret = p->deadlineMissCounter;
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+#endif
+
+#if OS_USE_CPU_BUDGET
+/**
+ * @brief Gives a thread a CPU budget
+ * @param h handle to the thread, 0 can be passed to change current thread
+ * @param budget the number of ticks the thread may run at its priority in every
+ * replenishment period, 0 to remove the budget
+ * @param period the replenishment period in ticks, not shorter than the budget
+ * @param backgroundPriority the priority the thread runs at after using up its
+ * budget, which must not be higher than the priority of the thread, nor be
+ * @ref OS_EDF_PRIORITY if @ref OS_USE_EDF is enabled
+ * @details Following a simplified sporadic server, the replenishment is scheduled
+ * one period after the thread starts to consume a full budget, and restores the
+ * full budget. A thread that uses up its budget keeps running at the background
+ * priority until then, so that it cannot starve the threads beneath its priority.
+ * Its preemption threshold follows the priority it runs at. The budget is charged
+ * by the tick handler to the thread running when the tick occurs. The full budget
+ * is available immediately.
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+void
+osThreadSetBudget( osHandle_t h, osCounter_t budget, osCounter_t period, osCounter_t backgroundPriority )
+{
+	Thread_t* p = (Thread_t*) h;
+
+	OS_ASSERT( budget <= period );
+#if OS_USE_EDF
+	OS_ASSERT( (budget == 0) || (backgroundPriority != OS_EDF_PRIORITY) );
+#endif
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		/* cancel the pending replenishment, if any */
+		if( p->budgetListItem.list != NULL )
+			list_remove( &p->budgetListItem );
+
+		/* return from the background priority, if the old budget was used up */
+		if( (p->budget != 0) && (p->budgetLeft == 0) )
+		{
+			p->preemptionThreshold = p->budgetPriority;
+			p->basePriority = p->budgetPriority;
+			mutex_updatePriority( p );
+		}
+
+		OS_ASSERT( (budget == 0) || (backgroundPriority >= p->basePriority) );
+
+		p->budget = budget;
+		p->budgetPeriod = period;
+		p->budgetLeft = budget;
+		p->budgetPriority = p->basePriority;
+		p->backgroundPriority = backgroundPriority;
+
+		if( thread_isPreemptionNeeded() )
+			thread_requestReschedule();
+	}
+	osThreadExitCritical();
+}
+
+/**
+ * @brief Returns the number of budget overruns of a thread
+ * @param h handle to the thread, 0 can be passed to check current thread
+ * @return the number of times the thread used up its CPU budget and dropped to
+ * its background priority
+ *
+ * @note contexts in which this function can be used
+ * 	- Yes: an interrupt context
+ * 	- Yes: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osThreadGetBudgetOverrunCounter( osHandle_t h )
+{
+	Thread_t* p = (Thread_t*) h;
+	osCounter_t ret;
+
+	if( h == 0 )
+		p = currentThread;
+
+	osThreadEnterCritical();
+	{
+		ret = p->budgetOverrunCounter;
+	}
+	osThreadExitCritical();
+
+	return ret;
+}
+#endif
@@ -29,8 +29,9 @@ timer_priorityBlockInit( TimerPriorityBlock_t* priorityBlock, Thread_t* daemon )
 {
 	notPrioritizedList_itemInit( & priorityBlock->timerPriorityListItem, priorityBlock );
 	priorityBlock->daemon = daemon;
-	prioritizedList_init( & priorityBlock->timerActiveList );
+	notPrioritizedList_init( & priorityBlock->timerExpiredList );
 	notPrioritizedList_init( & priorityBlock->timerInactiveList );
+	priorityBlock->activeCounter = 0;
 }
 
 TimerPriorityBlock_t*
@@ -169,18 +170,20 @@ osTimerDelete( osHandle_t timer )
 	{
 		priorityBlock = p->timerPriorityBlock;
 
-		/* timer has to be in the active or inactive list */
+		/* timer has to be in the timer wheel, the expired list or the inactive list */
 		OS_ASSERT( p->timerListItem.list );
 
-		/* this will remove the list item from priorritized list or not prioritized list,
-		 * whichever the item was in. */
+		if( p->timerListItem.list != (void*) & priorityBlock->timerInactiveList )
+			priorityBlock->activeCounter--;
+
+		/* this will remove the list item from the timer wheel or the lists of the
+		 * priority block, whichever the item was in. */
 		list_remove( &p->timerListItem );
 		memory_returnToHeap( p, & kernelMemoryList );
 
 		/* if the thread was suspended, it will not delete the timer priority block,
-		 * so it is necessary to check if there are still timers in the active or
-		 * inactive timer list */
-		if( (priorityBlock->timerActiveList.first == NULL) &&
+		 * so it is necessary to check if there are still active or inactive timers */
+		if( (priorityBlock->activeCounter == 0) &&
 			(priorityBlock->timerInactiveList.first == NULL) )
 		{
 			/*  delete the thread then remove and free the priority block */
@@ -208,20 +211,11 @@ osTimerStart( osHandle_t timer, void* argument )
 		{
 			p->argument = argument;
 
-			/* set the time of first wakeup */
-			p->futureTime = systemTime + p->period;
-
-			/* move this timer to the active list */
+			/* move this timer to the timer wheel, set the time of first wakeup. The
+			 * daemon thread will be resumed by the tick handler when the timer expires */
 			list_remove( & p->timerListItem );
-			prioritizedList_insert( (PrioritizedListItem_t*) & p->timerListItem, & p->timerPriorityBlock->timerActiveList );
-
-			/* check if daemon thread is suspended */
-			if( p->timerPriorityBlock->daemon->state == OSTHREAD_SUSPENDED )
-			{
-				/* resume daemon thread */
-				osThreadResume( (osHandle_t) p->timerPriorityBlock->daemon);
-			}
-
+			timingWheel_insert( & timers_timed, (PrioritizedListItem_t*) & p->timerListItem, TIME_NOW() + p->period );
+			p->timerPriorityBlock->activeCounter++;
 		}
 	}
 	osThreadExitCritical();
@@ -234,11 +228,12 @@ osTimerStop( osHandle_t timer )
 
 	osThreadEnterCritical();
 	{
-		/* if in active list, remove from it */
-		if( p->timerListItem.list == (void*) & p->timerPriorityBlock->timerActiveList )
+		/* if in the timer wheel or the expired list, remove from it */
+		if( p->timerListItem.list != (void*) & p->timerPriorityBlock->timerInactiveList )
 		{
 			/* remove */
-			list_remove( (PrioritizedListItem_t*) & p->timerListItem );
+			list_remove( & p->timerListItem );
+			p->timerPriorityBlock->activeCounter--;
 
 			/* insert into inactive list */
 			notPrioritizedList_insert( & p->timerListItem, & p->timerPriorityBlock->timerInactiveList );
@@ -254,12 +249,11 @@ osTimerReset( osHandle_t timer )
 
 	osThreadEnterCritical();
 	{
-		/* if in the active list, remove, modify and reinsert */
-		if( p->timerListItem.list == (void*) & p->timerPriorityBlock->timerActiveList )
+		/* if in the timer wheel or the expired list, remove, modify and reinsert */
+		if( p->timerListItem.list != (void*) & p->timerPriorityBlock->timerInactiveList )
 		{
-			list_remove( (PrioritizedListItem_t*) & p->timerListItem );
-			p->futureTime = systemTime + p->period;
-			prioritizedList_insert( (PrioritizedListItem_t*) & p->timerListItem, & p->timerPriorityBlock->timerActiveList );
+			list_remove( & p->timerListItem );
+			timingWheel_insert( & timers_timed, (PrioritizedListItem_t*) & p->timerListItem, TIME_NOW() + p->period );
 		}
 	}
 	osThreadExitCritical();
@@ -321,17 +315,46 @@ osTimerGetMode( osHandle_t timer )
 	return ret;
 }
 
-/* the daemon task that calls the callback function when a timer in the active list timed out.
+/* moves the timers that expired in the system timer wheel to the expired list of their
+ * timer priority block, and readies the daemon threads that have expired timers. Called
+ * by the tick handler, only the slots of the elapsed ticks are visited.
+ * */
+void
+timer_readyExpired( osCounter_t ticks )
+{
+	NotPrioritizedList_t expired;
+	Timer_t* timer;
+
+	/* this function has to be called in a critical section because it accesses global variables */
+	OS_ASSERT( criticalNesting );
+
+	notPrioritizedList_init( &expired );
+	timingWheel_takeExpired( &timers_timed, ticks, &expired );
+
+	while( expired.first != NULL )
+	{
+		timer = (Timer_t*) expired.first->container;
+
+		list_remove( & timer->timerListItem );
+		notPrioritizedList_insert( & timer->timerListItem, & timer->timerPriorityBlock->timerExpiredList );
+
+		/* the daemon suspends itself when there are no expired timers */
+		if( timer->timerPriorityBlock->daemon->state == OSTHREAD_SUSPENDED )
+			thread_makeReady( timer->timerPriorityBlock->daemon );
+	}
+}
+
+/* the daemon task that calls the callback function when a timer of its priority expired.
  *
- * If the timer active list is empty, while the inactive list is not, the thread will suspend
- * itself, until an active timer is added, when the thread should be resumed from suspension.
- * If both the active and inactive timer list is empty, the thread will exit after removing
- * and freeing its timer priority block from the system timer priority list.
+ * If no timer is expired, while there are timers running or inactive, the thread will
+ * suspend itself, until the tick handler moves an expired timer to the expired list and
+ * resumes the thread. If there are neither running nor inactive timers, the thread will
+ * exit after removing and freeing its timer priority block from the system timer priority
+ * list.
  * */
 void
 timerTask( TimerPriorityBlock_t* volatile priorityBlock )
 {
-	PrioritizedListItem_t* timerListItem;
 	Timer_t* timer;
 
 	osThreadEnterCritical();
@@ -339,48 +362,37 @@ timerTask( TimerPriorityBlock_t* volatile priorityBlock )
 		for( ; ; )
 		{
 
-			while( priorityBlock->timerActiveList.first != NULL )
+			while( priorityBlock->timerExpiredList.first != NULL )
 			{
-				/* get the first timer control block */
-				timerListItem = priorityBlock->timerActiveList.first;
+				/* get the first expired timer control block */
+				timer = (Timer_t*) priorityBlock->timerExpiredList.first->container;
 
-				/* check if timed out */
-				if( systemTime >= timerListItem->value )
-				{
-					/* timed out, call the callback function */
-
-					/* get the timer control block from the list item */
-					timer = (Timer_t*) timerListItem->container;
-
-					/* call the callback function */
-					timer->callback( timer->argument );
-
-					/* remove the timer from the active list. If it's periodic,
-					 * update the future time and insert again. If it's one-shot,
-					 * insert into the inactive list */
-					list_remove( timerListItem );
+				/* remove the timer from the expired list. If it's periodic,
+				 * insert into the timer wheel again. If it's one-shot, insert into
+				 * the inactive list. This is done before calling the callback
+				 * function, so that the callback function can stop, reset or
+				 * delete the timer. */
+				list_remove( & timer->timerListItem );
 
-					if( timer->mode == OSTIMERMODE_PERIODIC )
-					{
-						timerListItem->value = systemTime + timer->period;
-
-						prioritizedList_insert( timerListItem, & priorityBlock->timerActiveList );
-					}
-					else
-					{
-						notPrioritizedList_insert( & timer->timerListItem, & priorityBlock->timerInactiveList );
-					}
+				if( timer->mode == OSTIMERMODE_PERIODIC )
+				{
+					timingWheel_insert( & timers_timed, (PrioritizedListItem_t*) & timer->timerListItem,
+						TIME_NOW() + timer->period );
 				}
 				else
 				{
-					/* not timed out, delay for remaining time */
-					osThreadDelay( timerListItem->value - systemTime );
+					notPrioritizedList_insert( & timer->timerListItem, & priorityBlock->timerInactiveList );
+					priorityBlock->activeCounter--;
 				}
 
+				/* call the callback function */
+				timer->callback( timer->argument );
+
 			} /* while */
 
-			/* will go here once the active timer list becomes empty */
-			if( priorityBlock->timerInactiveList.first != NULL )
+			/* will go here once the expired timer list becomes empty */
+			if( (priorityBlock->activeCounter != 0) ||
+				(priorityBlock->timerInactiveList.first != NULL) )
 			{
 				osThreadSuspend(0);
 			}
@@ -0,0 +1,214 @@
+/** **************************************************************
+ * @file
+ * @brief Wait for multiple objects implementation
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of waiting for any of
+ * several objects. The waiting thread puts one list item into the list of
+ * selectors of each object, so that it is found by whichever object becomes
+ * ready first, and then takes all of them out again.
+ ****************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+/**
+ * @brief Tests if an object is ready
+ * @param object pointer to the object description
+ * @retval true if the operation the object is waited for would not block
+ * @retval false if it would block, or the object is a signal
+ * @note this function must be used in a critical section
+ */
+osBool_t
+waitAny_isReady( const osWaitObject_t* object )
+{
+	MutexBase_t* mutex;
+
+	switch( object->type )
+	{
+	case OSOBJECT_QUEUE:
+		return queue_getUsedSize( (Queue_t*) object->handle ) != 0;
+
+	case OSOBJECT_MESSAGE_QUEUE:
+		return ( (MessageQueue_t*) object->handle )->count != 0;
+
+	case OSOBJECT_SEMAPHORE:
+		return SEMAPHORE_COUNT( (Semaphore_t*) object->handle ) != 0;
+
+	case OSOBJECT_MUTEX:
+		mutex = &( (Mutex_t*) object->handle )->base;
+		return mutex->owner == NULL;
+
+	case OSOBJECT_RECURSIVE_MUTEX:
+		mutex = &( (RecursiveMutex_t*) object->handle )->base;
+		return (mutex->owner == NULL) || (mutex->owner == currentThread);
+
+	default:
+		/* a signal carries no state, it is only ready when sent */
+		return false;
+	}
+}
+
+/**
+ * @brief Prepares an object for a thread to wait for it
+ * @param object pointer to the object description
+ * @return pointer to the list of selectors of the object
+ * @details Makes sure the atomic fast paths of the object go through the kernel,
+ * where the selectors are notified.
+ * @note this function must be used in a critical section
+ */
+NotPrioritizedList_t*
+waitAny_prepare( const osWaitObject_t* object )
+{
+	Semaphore_t* semaphore;
+	MutexBase_t* mutex;
+
+	switch( object->type )
+	{
+	case OSOBJECT_QUEUE:
+		return &( (Queue_t*) object->handle )->selectors;
+
+	case OSOBJECT_MESSAGE_QUEUE:
+		return &( (MessageQueue_t*) object->handle )->selectors;
+
+	case OSOBJECT_SEMAPHORE:
+		semaphore = (Semaphore_t*) object->handle;
+#if OS_USE_ATOMICS
+		/* make the atomic increments of concurrent posts fail */
+		semaphore->counter = SEMAPHORE_CONTENDED;
+#endif
+		return &semaphore->selectors;
+
+	case OSOBJECT_MUTEX:
+	case OSOBJECT_RECURSIVE_MUTEX:
+		/* both mutex types start with the shared part */
+		mutex = &( (Mutex_t*) object->handle )->base;
+
+		/* a mutex in the list of its owner is never released by the atomic fast path */
+		mutex_register( mutex );
+		return &mutex->selectors;
+
+	default:
+		return &( (Signal_t*) object->handle )->selectors;
+	}
+}
+
+/**
+ * @brief Readies all the threads waiting for an object among others
+ * @param selectors pointer to the list of selectors of the object
+ * @details Each thread returns the index of the object from @ref osWaitAny. The
+ * list is not sorted by priority: all of its threads are readied and the
+ * scheduler picks among them, so a priority change leaves the list alone.
+ * @note this function must be used in a critical section
+ */
+void
+waitAny_notify( NotPrioritizedList_t* selectors )
+{
+	WaitAnyItem_t* item;
+	Thread_t* thread;
+
+	OS_ASSERT( criticalNesting );
+
+	if( selectors->first == NULL )
+		return;
+
+	do
+	{
+		item = (WaitAnyItem_t*) selectors->first;
+		thread = (Thread_t*) item->listItem.container;
+
+		/* thread_makeReady takes the thread out of the lists of all the objects */
+		thread->waitAny->index = item->index;
+		thread_makeReady( thread );
+
+	} while( selectors->first != NULL );
+
+	if( thread_isPreemptionNeeded() )
+		thread_requestReschedule();
+}
+
+/**
+ * @brief Takes a thread out of the lists of all the objects it waits for
+ * @param thread pointer to the thread control block
+ * @details Takes time proportional to the number of objects.
+ * @note this function must be used in a critical section
+ */
+void
+waitAny_abandon( Thread_t* thread )
+{
+	WaitAnyWait_t* wait = thread->waitAny;
+	osCounter_t i;
+
+	OS_ASSERT( criticalNesting );
+
+	for( i = 0; i < wait->count; i++ )
+	{
+		if( wait->items[i].listItem.list != NULL )
+			list_remove( &wait->items[i].listItem );
+	}
+
+	thread->waitAny = NULL;
+}
+
+/**
+ * @brief Waits for any of several objects to become ready
+ * @param objects array of the descriptions of the objects
+ * @param count number of objects, at most @ref OS_WAIT_ANY_MAX_OBJECTS
+ * @param timeout the maximum time in ticks to wait, 0 for indefinite
+ * @return the index of the object that is ready, @ref OS_WAIT_ANY_NONE if the
+ * wait timed out or the thread was suspended
+ * @details A queue is ready when it holds data, a message queue when it holds a
+ * message, a semaphore when its counter is not 0, a mutex when it is unlocked,
+ * and a signal when a signal value is sent onto it. The object is not taken, another thread can take it before the caller
+ * does, so the caller should take it with a non-blocking function and wait again
+ * if that fails. An object that is deleted is also reported as ready.
+ * @note contexts in which this function can be used
+ * 	- No: an interrupt context
+ * 	- No: main stack context before the kernel started
+ * 	- Yes: thread contexts
+ */
+osCounter_t
+osWaitAny( const osWaitObject_t* objects, osCounter_t count, osCounter_t timeout )
+{
+	WaitAnyItem_t items[OS_WAIT_ANY_MAX_OBJECTS];
+	WaitAnyWait_t wait;
+	osCounter_t i;
+
+	OS_ASSERT( objects != NULL );
+	OS_ASSERT( (count >= 1) && (count <= OS_WAIT_ANY_MAX_OBJECTS) );
+
+	osThreadEnterCritical();
+	{
+		wait.index = OS_WAIT_ANY_NONE;
+
+		for( i = 0; i < count; i++ )
+		{
+			OS_ASSERT( objects[i].handle );
+
+			if( waitAny_isReady( &objects[i] ) )
+			{
+				wait.index = i;
+				break;
+			}
+		}
+
+		if( wait.index == OS_WAIT_ANY_NONE )
+		{
+			wait.items = items;
+			wait.count = count;
+
+			for( i = 0; i < count; i++ )
+			{
+				notPrioritizedList_itemInit( &items[i].listItem, currentThread );
+				items[i].index = i;
+				notPrioritizedList_insert( &items[i].listItem, waitAny_prepare( &objects[i] ) );
+			}
+
+			currentThread->waitAny = &wait;
+			thread_blockCurrent( NULL, timeout, &wait );
+		}
+	}
+	osThreadExitCritical();
+
+	return wait.index;
+}
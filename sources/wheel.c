@@ -0,0 +1,158 @@
+/** *********************************************************************
+ * @file
+ * @brief Timing wheel functions
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file contains the implementation of the hashed timing
+ * wheel used for thread timeouts and timer expiries.
+ ***********************************************************************/
+#include "../includes/config.h"
+#include "../includes/types.h"
+#include "../includes/global.h"
+#include "../includes/functions.h"
+
+/**
+ * @brief Returns the slot of a timing wheel that holds a wake up time
+ * @param wheel pointer to the timing wheel
+ * @param time the absolute wake up time
+ * @return pointer to the slot
+ */
+#define WHEEL_SLOT(wheel, time) \
+	( &(wheel)->slots[ (time) & ( OS_TIMING_WHEEL_SIZE - 1 ) ] )
+
+/**
+ * @brief Initializes a timing wheel
+ * @param wheel pointer to the timing wheel to be initialized
+ */
+void
+timingWheel_init( TimingWheel_t* wheel )
+{
+	osCounter_t i;
+
+	for( i = 0; i < OS_TIMING_WHEEL_SIZE; i++ )
+		notPrioritizedList_init( &wheel->slots[i] );
+}
+
+/**
+ * @brief Inserts an item into a timing wheel
+ * @param wheel pointer to the timing wheel
+ * @param item pointer to the item to be inserted, which must not be in any list
+ * @param time the absolute wake up time of the item
+ * @details The item is appended to its slot in constant time. An item whose wake
+ * up time is not in the future is put into the slot of the next tick, so that it
+ * wakes up on the next tick. The item can be removed before it wakes up by calling
+ * @ref list_remove, which also takes constant time.
+ * @note this function must be used in a critical section
+ */
+void
+timingWheel_insert( TimingWheel_t* wheel, PrioritizedListItem_t* item, osCounter_t time )
+{
+	OS_ASSERT( criticalNesting );
+
+	item->value = time;
+
+	if( TIME_IS_REACHED(time, TIME_NOW()) )
+		time = TIME_NOW() + 1;
+
+	/* a prioritized list item can be casted to a not prioritized list item */
+	notPrioritizedList_insert( (NotPrioritizedListItem_t*) item, WHEEL_SLOT(wheel, time) );
+}
+
+/**
+ * @brief Moves the items that woke up from a timing wheel to a list
+ * @param wheel pointer to the timing wheel
+ * @param ticks the number of ticks @ref systemTime advanced since the last call,
+ * usually 1
+ * @param expired pointer to the list that receives the items whose wake up time
+ * is not later than @ref systemTime
+ * @details Only the slots of the ticks that elapsed are visited, which is a single
+ * slot when called every tick. Items in those slots that wake up in a later
+ * revolution of the wheel are left in place.
+ * @note this function must be used in a critical section
+ */
+void
+timingWheel_takeExpired( TimingWheel_t* wheel, osCounter_t ticks, NotPrioritizedList_t* expired )
+{
+	NotPrioritizedList_t* slot;
+	NotPrioritizedListItem_t *i, *next;
+
+	OS_ASSERT( criticalNesting );
+
+	/* every slot is visited at most once */
+	if( ticks > OS_TIMING_WHEEL_SIZE )
+		ticks = OS_TIMING_WHEEL_SIZE;
+
+	for( ; ticks > 0; ticks-- )
+	{
+		slot = WHEEL_SLOT( wheel, TIME_NOW() - ticks + 1 );
+
+		i = slot->first;
+		while( i != NULL )
+		{
+			/* point to the next item before moving this one, NULL if this is the
+			 * last item (the items before this one are either moved or kept) */
+			next = i->next;
+			if( next == slot->first )
+				next = NULL;
+
+			if( TIME_IS_REACHED( ((PrioritizedListItem_t*) i)->value, TIME_NOW() ) )
+			{
+				list_remove( i );
+				notPrioritizedList_insert( i, expired );
+			}
+
+			i = next;
+		}
+	}
+}
+
+#if OS_USE_TICKLESS_IDLE
+/**
+ * @brief Returns the number of ticks until the first item in a timing wheel wakes up
+ * @param wheel pointer to the timing wheel
+ * @return the number of ticks from @ref systemTime to the earliest wake up time,
+ * 0 if an item is already due, or @ref OS_TICKLESS_INFINITE_IDLE if the wheel is
+ * empty.
+ * @details The slots are visited in the order of the ticks following the current
+ * tick. The first item found to wake up in the current revolution of the wheel is
+ * the earliest, otherwise the earliest of all items in later revolutions is used.
+ * This function is only used by the idle thread, so visiting every slot is acceptable.
+ * @note this function must be used in a critical section
+ */
+osCounter_t
+timingWheel_getTicksToNext( TimingWheel_t* wheel )
+{
+	osCounter_t ticks = OS_TICKLESS_INFINITE_IDLE, offset, delta;
+	NotPrioritizedList_t* slot;
+	NotPrioritizedListItem_t* i;
+
+	OS_ASSERT( criticalNesting );
+
+	for( offset = 1; offset <= OS_TIMING_WHEEL_SIZE; offset++ )
+	{
+		slot = WHEEL_SLOT( wheel, TIME_NOW() + offset );
+
+		if( slot->first != NULL )
+		{
+			i = slot->first;
+			do {
+				if( TIME_IS_REACHED( ((PrioritizedListItem_t*) i)->value, TIME_NOW() ) )
+					return 0;
+
+				delta = ((PrioritizedListItem_t*) i)->value - TIME_NOW();
+
+				/* an item in the current revolution, no item can wake up earlier */
+				if( delta == offset )
+					return delta;
+
+				if( delta < ticks )
+					ticks = delta;
+
+				i = i->next;
+
+			} while( i != slot->first );
+		}
+	}
+
+	return ticks;
+}
+#endif
@@ -0,0 +1,153 @@
+/** ***********************************************************************
+ * @file
+ * @brief Queue handoff benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the round trip time of a message of 4 to 1024 bytes
+ * between two threads over two queues. The pinger waits for the answer
+ * before the ponger has sent it, so the answer is copied straight into the
+ * buffer of the blocked pinger instead of through the queue memory. For
+ * comparison, the same round trip with two semaphores and no data gives the
+ * cost of the two context switches alone.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_PINGER 		2
+#define PRIO_PONGER 		3
+
+#define MAX_SIZE 			1024
+#define ROUND_TRIPS 		200000
+
+static osHandle_t requests, answers, finished;
+static osCounter_t messageSize;
+static osBool_t useSemaphores;
+
+/**
+ * @brief Sends every message back
+ */
+static void
+pongerTask( const void* argument )
+{
+	osByte_t message[MAX_SIZE];
+	osCounter_t i;
+
+	for( i = 0; i < ROUND_TRIPS; i++ )
+	{
+		if( useSemaphores )
+		{
+			osSemaphoreWait( requests, 0 );
+			osSemaphorePost( answers );
+		}
+		else
+		{
+			osQueueReceive( requests, message, messageSize, 0 );
+			osQueueSend( answers, message, messageSize, 0 );
+		}
+	}
+}
+
+/**
+ * @brief Sends the messages and waits for each answer
+ */
+static void
+pingerTask( const void* argument )
+{
+	osByte_t message[MAX_SIZE];
+	osCounter_t i;
+
+	for( i = 0; i < ROUND_TRIPS; i++ )
+	{
+		if( useSemaphores )
+		{
+			osSemaphorePost( requests );
+			osSemaphoreWait( answers, 0 );
+		}
+		else
+		{
+			osQueueSend( requests, message, messageSize, 0 );
+			osQueueReceive( answers, message, messageSize, 0 );
+		}
+	}
+
+	osSemaphorePost( finished );
+}
+
+/**
+ * @brief Runs the round trips once
+ * @param size the size of the messages, ignored with semaphores
+ * @param semaphores true to synchronize with semaphores instead of queues
+ * @return the time per round trip in nanoseconds
+ */
+static double
+run( osCounter_t size, osBool_t semaphores )
+{
+	unsigned long long start;
+
+	messageSize = size;
+	useSemaphores = semaphores;
+
+	if( semaphores )
+	{
+		requests = osSemaphoreCreate( 0 );
+		answers = osSemaphoreCreate( 0 );
+	}
+	else
+	{
+		requests = osQueueCreate( MAX_SIZE );
+		answers = osQueueCreate( MAX_SIZE );
+	}
+
+	start = host_getNanoseconds();
+
+	osThreadCreate( PRIO_PONGER, (osCode_t) pongerTask, STACK_SIZE, 0 );
+	osThreadCreate( PRIO_PINGER, (osCode_t) pingerTask, STACK_SIZE, 0 );
+	osSemaphoreWait( finished, 0 );
+
+	start = host_getNanoseconds() - start;
+
+	if( semaphores )
+	{
+		osSemaphoreDelete( requests );
+		osSemaphoreDelete( answers );
+	}
+	else
+	{
+		osQueueDelete( requests );
+		osQueueDelete( answers );
+	}
+
+	return (double) start / ROUND_TRIPS;
+}
+
+/**
+ * @brief Reports the round trip times for growing messages
+ */
+static void
+controllerTask( const void* argument )
+{
+	osCounter_t size;
+
+	finished = osSemaphoreCreate( 0 );
+
+	printf( "%-12s %14.1f ns per round trip\n", "semaphores", run( 0, true ) );
+
+	for( size = 4; size <= MAX_SIZE; size *= 4 )
+		printf( "%-6s %5u %14.1f ns per round trip\n", "queue", (unsigned) size, run( size, false ) );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+/** ***********************************************************************
+ * @file
+ * @brief Interrupt masking window benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the longest time the interrupts stay masked while a
+ * thread that still holds blocks from osMemoryAllocate is deleted. The
+ * blocks are freed with the scheduler suspended, and the interrupts only
+ * masked around each block. For comparison, the same deletion is run inside
+ * one critical section, which is how the whole list used to be freed.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_VICTIM 		3
+
+#define BLOCK_SIZE 			64
+#define MAX_BLOCKS 			4096
+#define ROUNDS 				20
+
+static osHandle_t never;
+static osCounter_t blockCount;
+
+/**
+ * @brief Allocates its blocks and waits to be deleted
+ */
+static void
+victimTask( const void* argument )
+{
+	osCounter_t i;
+
+	for( i = 0; i < blockCount; i++ )
+		osMemoryAllocate( BLOCK_SIZE );
+
+	osSemaphoreWait( never, 0 );
+}
+
+/**
+ * @brief Deletes a thread holding blocks
+ * @param blocks the number of blocks the thread holds
+ * @param critical true to delete it inside one critical section
+ * @return the longest masked window in nanoseconds, the least of a few rounds
+ * so that the host preempting the process is left out
+ */
+static unsigned long long
+measure( osCounter_t blocks, osBool_t critical )
+{
+	unsigned long long least = (unsigned long long) -1;
+	osHandle_t victim;
+	osCounter_t round;
+
+	blockCount = blocks;
+
+	for( round = 0; round < ROUNDS; round++ )
+	{
+		victim = osThreadCreate( PRIO_VICTIM, (osCode_t) victimTask, STACK_SIZE, 0 );
+		osThreadDelay( 1 );
+
+		host_resetMaskedWindow();
+
+		if( critical )
+			osThreadEnterCritical();
+
+		osThreadDelete( victim );
+
+		if( critical )
+			osThreadExitCritical();
+
+		if( host_getMaskedWindow() < least )
+			least = host_getMaskedWindow();
+	}
+
+	return least;
+}
+
+/**
+ * @brief Reports the windows for growing numbers of blocks
+ */
+static void
+controllerTask( const void* argument )
+{
+	osCounter_t blocks;
+
+	never = osSemaphoreCreate( 0 );
+
+	printf( "%10s %20s %20s\n", "blocks", "one section ns", "scheduler lock ns" );
+
+	for( blocks = 16; blocks <= MAX_BLOCKS; blocks *= 4 )
+		printf( "%10u %20llu %20llu\n", (unsigned) blocks, measure( blocks, true ), measure( blocks, false ) );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
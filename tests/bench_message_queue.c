@@ -0,0 +1,107 @@
+/** ***********************************************************************
+ * @file
+ * @brief Message queue benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the time to send and receive an item of 4, 16 and 64
+ * bytes, through a message queue and through a byte queue of the same
+ * capacity. The queues are filled and then drained a batch at a time, so
+ * that the positions wrap around, and nobody waits on them.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+
+#define ITEM_COUNT 			50
+#define MAX_ITEM_SIZE 		64
+#define BATCHES 			40000
+
+static osByte_t item[MAX_ITEM_SIZE];
+
+/**
+ * @brief Moves the items through a message queue
+ * @return the time per item in nanoseconds
+ */
+static double
+benchMessageQueue( osCounter_t itemSize )
+{
+	osHandle_t queue = osMessageQueueCreate( itemSize, ITEM_COUNT );
+	unsigned long long start;
+	osCounter_t batch, i;
+
+	start = host_getNanoseconds();
+
+	for( batch = 0; batch < BATCHES; batch++ )
+	{
+		for( i = 0; i < ITEM_COUNT; i++ )
+			osMessageQueueSendNonBlock( queue, item );
+
+		for( i = 0; i < ITEM_COUNT; i++ )
+			osMessageQueueReceiveNonBlock( queue, item );
+	}
+
+	start = host_getNanoseconds() - start;
+	CHECK( osMessageQueueGetCount( queue ) == 0 );
+	osMessageQueueDelete( queue );
+
+	return (double) start / ( (double) BATCHES * ITEM_COUNT );
+}
+
+/**
+ * @brief Moves the items through a byte queue
+ * @return the time per item in nanoseconds
+ */
+static double
+benchQueue( osCounter_t itemSize )
+{
+	osHandle_t queue = osQueueCreate( itemSize * ITEM_COUNT );
+	unsigned long long start;
+	osCounter_t batch, i;
+
+	start = host_getNanoseconds();
+
+	for( batch = 0; batch < BATCHES; batch++ )
+	{
+		for( i = 0; i < ITEM_COUNT; i++ )
+			osQueueSendNonBlock( queue, item, itemSize );
+
+		for( i = 0; i < ITEM_COUNT; i++ )
+			osQueueReceiveNonBlock( queue, item, itemSize );
+	}
+
+	start = host_getNanoseconds() - start;
+	CHECK( osQueueGetUsedSize( queue ) == 0 );
+	osQueueDelete( queue );
+
+	return (double) start / ( (double) BATCHES * ITEM_COUNT );
+}
+
+/**
+ * @brief Reports the times for each item size
+ */
+static void
+controllerTask( const void* argument )
+{
+	osCounter_t itemSize;
+
+	printf( "%10s %18s %18s\n", "item size", "byte queue ns", "message queue ns" );
+
+	for( itemSize = 4; itemSize <= MAX_ITEM_SIZE; itemSize *= 4 )
+		printf( "%10u %18.1f %18.1f\n", (unsigned) itemSize, benchQueue( itemSize ), benchMessageQueue( itemSize ) );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
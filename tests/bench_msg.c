@@ -0,0 +1,147 @@
+/** ***********************************************************************
+ * @file
+ * @brief Synchronous message passing benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the round trip time of a request and a reply of 4 to
+ * 1024 bytes between a client and a server of a lower priority, through
+ * osMsgSend, osMsgReceive and osMsgReply, and through a request queue and
+ * a reply queue as such servers are written without them. It also counts
+ * the context switches per round trip.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_CLIENT 		2
+#define PRIO_SERVER 		3
+
+#define MAX_SIZE 			1024
+#define ROUND_TRIPS 		200000
+
+static osHandle_t channel, requests, replies, finished;
+static osCounter_t messageSize;
+static osBool_t useQueues;
+static osCounter_t switches;
+
+/**
+ * @brief Answers every request with a reply of the same size
+ */
+static void
+serverTask( const void* argument )
+{
+	osByte_t message[MAX_SIZE];
+	osCounter_t size, i;
+	osHandle_t client;
+
+	for( i = 0; i < ROUND_TRIPS; i++ )
+	{
+		if( useQueues )
+		{
+			osQueueReceive( requests, message, messageSize, 0 );
+			osQueueSend( replies, message, messageSize, 0 );
+		}
+		else
+		{
+			size = MAX_SIZE;
+			client = osMsgReceive( channel, message, &size, 0 );
+			osMsgReply( client, message, size );
+		}
+	}
+}
+
+/**
+ * @brief Sends the requests and waits for each reply
+ */
+static void
+clientTask( const void* argument )
+{
+	osByte_t request[MAX_SIZE], reply[MAX_SIZE];
+	osCounter_t size, i;
+
+	for( i = 0; i < ROUND_TRIPS; i++ )
+	{
+		if( useQueues )
+		{
+			osQueueSend( requests, request, messageSize, 0 );
+			osQueueReceive( replies, reply, messageSize, 0 );
+		}
+		else
+		{
+			size = MAX_SIZE;
+			osMsgSend( channel, request, messageSize, reply, &size, 0 );
+		}
+	}
+
+	osSemaphorePost( finished );
+}
+
+/**
+ * @brief Runs the round trips once
+ * @param size the size of the requests and the replies
+ * @param queues true to use two queues instead of a channel
+ * @return the time per round trip in nanoseconds
+ */
+static double
+run( osCounter_t size, osBool_t queues )
+{
+	unsigned long long start;
+	osCounter_t firstSwitch;
+
+	messageSize = size;
+	useQueues = queues;
+
+	firstSwitch = host_getSwitchCount();
+	start = host_getNanoseconds();
+
+	osThreadCreate( PRIO_SERVER, (osCode_t) serverTask, STACK_SIZE, 0 );
+	osThreadCreate( PRIO_CLIENT, (osCode_t) clientTask, STACK_SIZE, 0 );
+	osSemaphoreWait( finished, 0 );
+
+	start = host_getNanoseconds() - start;
+	switches = host_getSwitchCount() - firstSwitch;
+
+	return (double) start / ROUND_TRIPS;
+}
+
+/**
+ * @brief Reports the round trip times for growing messages
+ */
+static void
+controllerTask( const void* argument )
+{
+	osCounter_t size, queueSwitches;
+	double queues, channels;
+
+	finished = osSemaphoreCreate( 0 );
+	channel = osMsgChannelCreate();
+	requests = osQueueCreate( MAX_SIZE );
+	replies = osQueueCreate( MAX_SIZE );
+
+	printf( "%10s %14s %14s %16s %16s\n", "size", "queues ns", "channel ns", "queues switches", "channel switches" );
+
+	for( size = 4; size <= MAX_SIZE; size *= 4 )
+	{
+		queues = run( size, true );
+		queueSwitches = switches;
+		channels = run( size, false );
+
+		printf( "%10u %14.1f %14.1f %16.2f %16.2f\n", (unsigned) size, queues, channels,
+				(double) queueSwitches / ROUND_TRIPS, (double) switches / ROUND_TRIPS );
+	}
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
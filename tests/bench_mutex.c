@@ -0,0 +1,52 @@
+/** ***********************************************************************
+ * @file
+ * @brief Uncontended mutex benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the time of an uncontended lock and unlock pair. It is
+ * built twice, with OS_USE_ATOMICS for the atomic fast path, and without it
+ * for the critical section path every call used to take.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+
+#define PAIRS 				2000000
+
+/**
+ * @brief Locks and unlocks a mutex nobody else uses
+ */
+static void
+controllerTask( const void* argument )
+{
+	osHandle_t mutex = osMutexCreate();
+	unsigned long long start;
+	osCounter_t i;
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < PAIRS; i++ )
+	{
+		osMutexLock( mutex, 0 );
+		osMutexUnlock( mutex );
+	}
+
+	printf( "%-16s %6.1f ns per lock and unlock\n", OS_USE_ATOMICS ? "atomic" : "critical section",
+			(double)( host_getNanoseconds() - start ) / PAIRS );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
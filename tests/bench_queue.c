@@ -0,0 +1,112 @@
+/** ***********************************************************************
+ * @file
+ * @brief Queue copy throughput benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the throughput of writing data into a queue and reading
+ * it back, for sizes from 1 byte to 4 KiB, with the copy done in at most
+ * two memcpy segments, and with the copy of one byte per iteration and one
+ * wrap check per byte the queue used before. Only the copy differs, both run
+ * on the same queue inside a critical section, as the kernel calls do.
+ *************************************************************************/
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define QUEUE_SIZE 			10000
+#define MAX_SIZE 			4096
+#define TOTAL_BYTES 		( 16 * 1024 * 1024 )
+
+static osByte_t source[MAX_SIZE];
+static osByte_t destination[MAX_SIZE];
+
+/**
+ * @brief Writes data to the queue one byte at a time
+ */
+static void
+byteWrite( Queue_t* queue, const void* data, osCounter_t size )
+{
+	osCounter_t counter = 0;
+
+	for( ; counter < size; counter++ )
+	{
+		queue->memory[queue->write] = ( (const osByte_t*) data )[counter];
+
+		if( queue->write < queue->size - 1 )
+			queue->write++;
+		else
+			queue->write = 0;
+	}
+}
+
+/**
+ * @brief Reads data from the queue one byte at a time
+ */
+static void
+byteRead( Queue_t* queue, void* data, osCounter_t size )
+{
+	osCounter_t counter = 0;
+
+	for( ; counter < size; counter++ )
+	{
+		( (osByte_t*) data )[counter] = queue->memory[queue->read];
+
+		if( queue->read < queue->size - 1 )
+			queue->read++;
+		else
+			queue->read = 0;
+	}
+}
+
+/**
+ * @brief Moves data through the queue in pieces of the given size
+ * @param bytewise true for the byte copy, false for the segment copy
+ * @return the throughput in MB/s
+ */
+static double
+measure( Queue_t* queue, osCounter_t size, osBool_t bytewise )
+{
+	osCounter_t pieces = TOTAL_BYTES / size;
+	unsigned long long start;
+	osCounter_t i;
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < pieces; i++ )
+	{
+		osThreadEnterCritical();
+		if( bytewise )
+			byteWrite( queue, source, size );
+		else
+			queue_write( queue, source, size );
+		osThreadExitCritical();
+
+		osThreadEnterCritical();
+		if( bytewise )
+			byteRead( queue, destination, size );
+		else
+			queue_read( queue, destination, size );
+		osThreadExitCritical();
+	}
+
+	return (double) pieces * size * 1000.0 / (double)( host_getNanoseconds() - start );
+}
+
+int
+main( void )
+{
+	Queue_t* queue;
+	osCounter_t size;
+
+	osInit();
+
+	/* an odd size, so that the pieces wrap at every position */
+	queue = (Queue_t*) osQueueCreate( QUEUE_SIZE );
+
+	printf( "%10s %16s %16s\n", "size", "bytes MB/s", "segments MB/s" );
+
+	for( size = 1; size <= MAX_SIZE; size *= 4 )
+		printf( "%10u %16.1f %16.1f\n", (unsigned) size, measure( queue, size, true ), measure( queue, size, false ) );
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+/** ***********************************************************************
+ * @file
+ * @brief Single-producer single-consumer ring benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the time to write and read a chunk of 1 to 256 bytes
+ * through the ring, which takes no critical section, and through a byte
+ * queue of the same size, which masks the interrupts in every call. It then
+ * streams data from a producer on a second host thread to the main thread
+ * through the ring, and reports the throughput.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define RING_SIZE 			1024
+#define MAX_CHUNK 			256
+#define TOTAL_BYTES 		( 16 * 1024 * 1024 )
+#define STREAM_BYTES 		( 16 * 1024 * 1024 )
+
+static osByte_t chunk[MAX_CHUNK];
+static osHandle_t ring;
+static osCounter_t streamChunk;
+
+/**
+ * @brief Moves the chunks through the ring
+ * @return the time per chunk in nanoseconds
+ */
+static double
+benchRing( osCounter_t size )
+{
+	osCounter_t chunks = TOTAL_BYTES / size;
+	unsigned long long start;
+	osCounter_t i;
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < chunks; i++ )
+	{
+		osSpscRingWrite( ring, chunk, size );
+		osSpscRingRead( ring, chunk, size );
+	}
+
+	return (double)( host_getNanoseconds() - start ) / chunks;
+}
+
+/**
+ * @brief Moves the chunks through a byte queue
+ * @return the time per chunk in nanoseconds
+ */
+static double
+benchQueue( osHandle_t queue, osCounter_t size )
+{
+	osCounter_t chunks = TOTAL_BYTES / size;
+	unsigned long long start;
+	osCounter_t i;
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < chunks; i++ )
+	{
+		osQueueSendNonBlock( queue, chunk, size );
+		osQueueReceiveNonBlock( queue, chunk, size );
+	}
+
+	return (double)( host_getNanoseconds() - start ) / chunks;
+}
+
+static void*
+producerMain( void* argument )
+{
+	osByte_t data[MAX_CHUNK];
+	osCounter_t position = 0, written;
+
+	while( position < STREAM_BYTES )
+	{
+		written = osSpscRingWrite( ring, data, streamChunk );
+		position += written;
+
+		/* let the consumer run on a single core host */
+		if( written == 0 )
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Streams data from a second host thread through the ring
+ * @return the throughput in MB/s
+ */
+static double
+stream( osCounter_t size )
+{
+	osByte_t data[MAX_CHUNK];
+	osCounter_t position = 0, read;
+	unsigned long long start;
+	pthread_t producer;
+
+	streamChunk = size;
+	start = host_getNanoseconds();
+
+	pthread_create( &producer, NULL, producerMain, NULL );
+
+	while( position < STREAM_BYTES )
+	{
+		read = osSpscRingRead( ring, data, size );
+		position += read;
+
+		if( read == 0 )
+			sched_yield();
+	}
+
+	pthread_join( producer, NULL );
+
+	return (double) STREAM_BYTES * 1000.0 / (double)( host_getNanoseconds() - start );
+}
+
+int
+main( void )
+{
+	osHandle_t queue;
+	osCounter_t size;
+
+	osInit();
+
+	ring = osSpscRingCreate( RING_SIZE );
+	queue = osQueueCreate( RING_SIZE );
+
+	printf( "%10s %14s %14s %16s\n", "chunk", "queue ns", "ring ns", "stream MB/s" );
+
+	for( size = 1; size <= MAX_CHUNK; size *= 4 )
+		printf( "%10u %14.1f %14.1f %16.1f\n", (unsigned) size, benchQueue( queue, size ), benchRing( size ), stream( size ) );
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+/** ***********************************************************************
+ * @file
+ * @brief Preemption threshold benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details A producer posts batches of items to a semaphore that a consumer
+ * of a higher priority waits on, and waits for the consumer to take the
+ * whole batch. Without a threshold, every post preempts the producer. With
+ * the threshold of the producer at the priority of the consumer, the
+ * consumer only runs once the producer blocks at the end of the batch. The
+ * benchmark counts the context switches and the time per item for both.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_CONSUMER 		4
+#define PRIO_PRODUCER 		6
+
+#define BATCH 				16
+#define ITEMS 				( BATCH * 20000 )
+
+static osHandle_t items, done, finished;
+static osCounter_t threshold;
+
+/**
+ * @brief Takes the items, and reports every whole batch
+ */
+static void
+consumerTask( const void* argument )
+{
+	osCounter_t i;
+
+	for( i = 1; i <= ITEMS; i++ )
+	{
+		osSemaphoreWait( items, 0 );
+
+		if( i % BATCH == 0 )
+			osSemaphorePost( done );
+	}
+}
+
+/**
+ * @brief Posts the items a batch at a time
+ */
+static void
+producerTask( const void* argument )
+{
+	osCounter_t i;
+
+	osThreadSetPreemptionThreshold( 0, threshold );
+
+	for( i = 1; i <= ITEMS; i++ )
+	{
+		osSemaphorePost( items );
+
+		if( i % BATCH == 0 )
+			osSemaphoreWait( done, 0 );
+	}
+
+	osSemaphorePost( finished );
+}
+
+/**
+ * @brief Runs the workload once
+ * @param name the name of the run in the report
+ * @param producerThreshold the preemption threshold of the producer
+ */
+static void
+run( const char* name, osCounter_t producerThreshold )
+{
+	osCounter_t switches = host_getSwitchCount();
+	unsigned long long start = host_getNanoseconds();
+
+	threshold = producerThreshold;
+
+	osThreadCreate( PRIO_CONSUMER, (osCode_t) consumerTask, STACK_SIZE, 0 );
+	osThreadCreate( PRIO_PRODUCER, (osCode_t) producerTask, STACK_SIZE, 0 );
+	osSemaphoreWait( finished, 0 );
+
+	switches = host_getSwitchCount() - switches;
+
+	printf( "%-14s %10u switches %8.3f per item %8.1f ns per item\n", name, (unsigned) switches,
+			(double) switches / ITEMS, (double)( host_getNanoseconds() - start ) / ITEMS );
+}
+
+/**
+ * @brief Runs the workload without and with the threshold
+ */
+static void
+controllerTask( const void* argument )
+{
+	items = osSemaphoreCreate( 0 );
+	done = osSemaphoreCreate( 0 );
+	finished = osSemaphoreCreate( 0 );
+
+	run( "no threshold", PRIO_PRODUCER );
+	run( "threshold", PRIO_CONSUMER );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/** ***********************************************************************
+ * @file
+ * @brief Timing wheel benchmark
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Measures the cost of arming a timeout while a number of other
+ * sleepers are waiting, for the timing wheel and for the sorted list the
+ * timeouts used to be kept in. Each step cancels the timeout of one sleeper
+ * and arms it again at a pseudo random tick up to a second away, as a
+ * thread blocking again with a timeout does.
+ *************************************************************************/
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#include <stdio.h>
+
+#define MAX_SLEEPERS 		1024
+#define STEPS 				200000
+#define MAX_DELAY 			1000
+
+static PrioritizedListItem_t items[MAX_SLEEPERS];
+static TimingWheel_t wheel;
+static PrioritizedList_t list;
+static osCounter_t seed;
+
+/**
+ * @brief Returns the next pseudo random delay
+ */
+static osCounter_t
+nextDelay( void )
+{
+	seed = seed * 1103515245 + 12345;
+
+	return 1 + (seed >> 16) % MAX_DELAY;
+}
+
+/**
+ * @brief Re-arms the timeouts in the sorted list
+ * @return the time per step in nanoseconds
+ */
+static double
+benchList( osCounter_t sleepers )
+{
+	unsigned long long start;
+	osCounter_t i;
+
+	seed = 1;
+	prioritizedList_init( &list );
+
+	for( i = 0; i < sleepers; i++ )
+	{
+		prioritizedList_itemInit( &items[i], NULL, (osCounter_t) systemTime + nextDelay() );
+		prioritizedList_insert( &items[i], &list );
+	}
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < STEPS; i++ )
+	{
+		PrioritizedListItem_t* item = &items[i % sleepers];
+
+		list_remove( item );
+		item->value = (osCounter_t) systemTime + nextDelay();
+		prioritizedList_insert( item, &list );
+	}
+
+	return (double)( host_getNanoseconds() - start ) / STEPS;
+}
+
+/**
+ * @brief Re-arms the timeouts in the timing wheel
+ * @return the time per step in nanoseconds
+ */
+static double
+benchWheel( osCounter_t sleepers )
+{
+	unsigned long long start;
+	osCounter_t i;
+
+	seed = 1;
+	timingWheel_init( &wheel );
+
+	for( i = 0; i < sleepers; i++ )
+	{
+		prioritizedList_itemInit( &items[i], NULL, 0 );
+		timingWheel_insert( &wheel, &items[i], (osCounter_t) systemTime + nextDelay() );
+	}
+
+	start = host_getNanoseconds();
+
+	for( i = 0; i < STEPS; i++ )
+	{
+		PrioritizedListItem_t* item = &items[i % sleepers];
+
+		list_remove( item );
+		timingWheel_insert( &wheel, item, (osCounter_t) systemTime + nextDelay() );
+	}
+
+	return (double)( host_getNanoseconds() - start ) / STEPS;
+}
+
+int
+main( void )
+{
+	osCounter_t sleepers;
+
+	osInit();
+
+	printf( "%10s %14s %14s\n", "sleepers", "sorted ns", "wheel ns" );
+
+	osThreadEnterCritical();
+	{
+		for( sleepers = 16; sleepers <= MAX_SLEEPERS; sleepers *= 4 )
+			printf( "%10u %14.1f %14.1f\n", (unsigned) sleepers, benchList( sleepers ), benchWheel( sleepers ) );
+	}
+	osThreadExitCritical();
+
+	return 0;
+}
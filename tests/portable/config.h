@@ -0,0 +1,57 @@
+/** ***********************************************************************
+ * @file
+ * @brief Host port configuration file
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file configures the kernel for the host port used by the
+ * tests. The kernel runs in one host process, see port.c. Kernel options
+ * can still be overridden on the compiler command line.
+ *************************************************************************/
+#ifndef H7E0C2A1D_5B3F_4C8E_9A64_2F1D0B7E93C5
+#define H7E0C2A1D_5B3F_4C8E_9A64_2F1D0B7E93C5
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint32_t 		osCounter_t;
+typedef uint8_t 		osByte_t;
+typedef bool 			osBool_t;
+typedef uintptr_t 		osHandle_t;
+typedef void* 			osCode_t;
+typedef uint32_t 		osSignalValue_t;
+
+/** @brief Reports a failed assertion and aborts the test */
+#define OS_ASSERT(condition) \
+	( (condition) ? (void) 0 : host_assertFailed( __FILE__, __LINE__, #condition ) )
+
+void host_assertFailed( const char* file, int line, const char* condition );
+
+#define OS_INLINE 						static inline
+#define OS_INTERRUPT
+#define OS_NORETURN 					__attribute__((noreturn))
+
+/** @brief The tick handler is called by the idle thread, or by a test */
+#define OS_TICK_HANDLER_NAME 			host_tickHandler
+
+#define OS_PRIO_LOWEST 					31
+
+/** @brief Logical interrupt priorities 1 and 2 may call the kernel */
+#define OS_KERNEL_INTERRUPT_CEILING 	2
+
+#define OS_MEMORY_ALIGNMENT 			16
+
+/** @brief The stacks also hold the host context of a thread */
+#define OS_IDLE_THREAD_STACK_SIZE 		65536
+#define OS_TIMER_THREAD_STACK_SIZE 		65536
+
+#define HOST_HEAP_SIZE 					( 4 * 1024 * 1024 )
+
+extern osByte_t hostHeap[HOST_HEAP_SIZE];
+
+#define OS_HEAP_START_ADDR 				( hostHeap )
+#define OS_HEAP_END_ADDR 				( hostHeap + HOST_HEAP_SIZE )
+
+/** @brief The stress tests run producers and consumers on several host cores */
+#define OS_MEMORY_BARRIER() 			__sync_synchronize()
+
+#endif /* H7E0C2A1D_5B3F_4C8E_9A64_2F1D0B7E93C5 */
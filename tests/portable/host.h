@@ -0,0 +1,98 @@
+/** ***********************************************************************
+ * @file
+ * @brief Host port test helpers
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file declares the functions the host port offers to the
+ * tests, on top of the portable layer.
+ *************************************************************************/
+#ifndef H4A9D61F0_2C7B_4E15_B83D_9F5C0E1A7D24
+#define H4A9D61F0_2C7B_4E15_B83D_9F5C0E1A7D24
+
+#include "config.h"
+
+/**
+ * @brief Checks a condition, a failed check is reported and makes the test fail
+ * @param condition the condition that must hold
+ */
+#define CHECK(condition) \
+	host_check( (condition), __FILE__, __LINE__, #condition )
+
+void host_check( osBool_t condition, const char* file, int line, const char* text );
+
+/**
+ * @brief Ends the test, with a failure if any check failed
+ */
+void host_finish( void ) __attribute__((noreturn));
+
+/**
+ * @brief The tick handler of the kernel, see @ref OS_TICK_HANDLER_NAME
+ * @details A test calls it to emulate a tick interrupt at that point.
+ */
+void host_tickHandler( void );
+
+/**
+ * @brief Emulates an interrupt
+ * @param priority the logical priority of the interrupt, from 1, see
+ * @ref OS_KERNEL_INTERRUPT_CEILING
+ * @param handler the interrupt handler
+ * @return true if the handler ran right away, false if it is pended because its
+ * priority is masked or not above the one of the running handler
+ * @details A pended handler runs as soon as the mask drops below its priority.
+ * Without @ref OS_USE_INTERRUPT_CEILING, critical sections mask every priority.
+ */
+osBool_t host_interrupt( osCounter_t priority, void (*handler)( void ) );
+
+/**
+ * @brief Runs a function and catches a failed kernel assertion in it
+ * @param function the function to run, or to emulate an interrupt from
+ * @return true if an assertion failed, which ends the function right there
+ * @details The interrupt mask and priority, and the critical section nesting of
+ * the kernel, are restored after a failed assertion.
+ */
+osBool_t host_catchAssert( void (*function)( void ) );
+
+/**
+ * @brief Returns the number of context switches since the kernel started
+ */
+osCounter_t host_getSwitchCount( void );
+
+/**
+ * @brief Starts measuring the longest time the interrupts stay masked
+ * @details Nothing is measured before the first call, which keeps the critical
+ * sections of the tests free of clock reads.
+ */
+void host_resetMaskedWindow( void );
+
+/**
+ * @brief Returns the longest time the interrupts stayed masked
+ * @return the time in nanoseconds, since @ref host_resetMaskedWindow
+ */
+unsigned long long host_getMaskedWindow( void );
+
+/**
+ * @brief Returns the time of the monotonic clock of the host, for the benchmarks
+ * @return the time in nanoseconds since an arbitrary point
+ */
+unsigned long long host_getNanoseconds( void );
+
+#if OS_USE_TICKLESS_IDLE
+/**
+ * @brief Returns the number of times the idle thread stopped the tick
+ */
+osCounter_t host_getSuppressCount( void );
+
+/**
+ * @brief Returns the number of ticks the idle thread asked to sleep the last
+ * time it stopped the tick, see @ref port_suppressTicks
+ */
+osCounter_t host_getSuppressRequest( void );
+
+/**
+ * @brief Ends the next tickless sleep early with an interrupt
+ * @param ticks the number of ticks the sleep lasts, if it is shorter than asked
+ * @param handler the interrupt handler that wakes the CPU, at priority 1
+ */
+void host_wakeUpEarly( osCounter_t ticks, void (*handler)( void ) );
+#endif
+
+#endif /* H4A9D61F0_2C7B_4E15_B83D_9F5C0E1A7D24 */
@@ -0,0 +1,447 @@
+/** ***********************************************************************
+ * @file
+ * @brief Host port used by the tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details This file implements the portable layer on a host process.
+ * Every thread runs on its own ucontext. Interrupts are emulated by the tests
+ * with @ref host_interrupt: a handler runs on the stack of the thread it
+ * interrupts, unless its logical priority is masked, or not above the one of
+ * the running handler, in which case it is pended until the mask drops. A
+ * yield requested while interrupts are masked or in a handler switches threads
+ * once the mask drops and the handlers return, as a pended context switch
+ * interrupt would. The idle thread calls the tick handler, so time only
+ * advances while every other thread is blocked, which makes timeouts
+ * deterministic.
+ *************************************************************************/
+#include "../includes/portable.h"
+#include "host.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+
+/**
+ * @brief Number of ticks the idle thread runs for in a row before the test
+ * is considered deadlocked
+ */
+#define HOST_IDLE_TICK_LIMIT 		100000
+
+/**
+ * @brief The interrupt mask set by @ref port_disableInterrupts, above every
+ * logical priority
+ */
+#define HOST_MASK_ALL 				( (osCounter_t) -1 )
+
+/**
+ * @brief Number of interrupts that can be pending at once
+ */
+#define HOST_PENDING_MAX 			8
+
+/**
+ * @brief The context of a thread, kept at the top of its stack
+ */
+typedef struct
+{
+	ucontext_t context;			/**< @brief the registers and the signal mask */
+	osCode_t code;				/**< @brief the function the thread runs */
+	const void* argument;		/**< @brief the argument of the function */
+} HostContext_t;
+
+/**
+ * @brief An emulated interrupt
+ */
+typedef struct
+{
+	osCounter_t priority;		/**< @brief the logical priority, from 1 */
+	void (*handler)( void );	/**< @brief the interrupt handler */
+} HostInterrupt_t;
+
+osByte_t hostHeap[HOST_HEAP_SIZE] __attribute__((aligned(OS_MEMORY_ALIGNMENT)));
+
+/* interrupts up to this logical priority are masked, 0 if none is */
+static volatile osCounter_t interruptMask;
+
+/* the logical priority of the running handler, 0 if none runs */
+static volatile osCounter_t interruptPriority;
+
+static HostInterrupt_t pending[HOST_PENDING_MAX];
+static osCounter_t pendingCount;
+
+static volatile osBool_t yieldPending;
+static osCounter_t idleTicks;
+static osCounter_t switchCount;
+
+/* the longest time the interrupts stayed masked, once measured */
+static osBool_t measuringMask;
+static unsigned long long maskedSince;
+static unsigned long long longestMasked;
+static osCounter_t failures;
+static jmp_buf* assertCatcher;
+
+#if OS_USE_TICKLESS_IDLE
+static osCounter_t suppressCount;
+static osCounter_t suppressRequest;
+static osCounter_t wakeUpTicks;
+static void (*wakeUpHandler)( void );
+#endif
+
+/**
+ * @brief Loads next thread, as the context switch interrupt does
+ */
+static void
+host_switch( void )
+{
+	Thread_t* previous = currentThread;
+
+	yieldPending = false;
+	currentThread = nextThread;
+
+	if( currentThread != &idleThread )
+		idleTicks = 0;
+
+	if( previous != currentThread )
+	{
+		switchCount++;
+		swapcontext( &( (HostContext_t*) previous->PSP )->context,
+				&( (HostContext_t*) currentThread->PSP )->context );
+	}
+}
+
+/**
+ * @brief Runs the function of a thread, a thread that returns is suspended
+ */
+static void
+host_threadEntry( void )
+{
+	HostContext_t* context = (HostContext_t*) currentThread->PSP;
+
+	( (void (*)( const void* )) context->code )( context->argument );
+
+	for( ; ; )
+		osThreadSuspend( 0 );
+}
+
+/**
+ * @brief Sets the interrupt mask, and measures how long it stays up
+ */
+static void
+host_setMask( osCounter_t mask )
+{
+	unsigned long long now;
+
+	if( measuringMask && ( (interruptMask == 0) != (mask == 0) ) )
+	{
+		now = host_getNanoseconds();
+
+		if( mask != 0 )
+			maskedSince = now;
+		else if( now - maskedSince > longestMasked )
+			longestMasked = now - maskedSince;
+	}
+
+	interruptMask = mask;
+}
+
+/**
+ * @brief Runs an interrupt handler at its logical priority
+ */
+static void
+host_runInterrupt( HostInterrupt_t interrupt )
+{
+	osCounter_t preempted = interruptPriority;
+
+	interruptPriority = interrupt.priority;
+	interrupt.handler();
+	interruptPriority = preempted;
+}
+
+/**
+ * @brief Runs the pending interrupts that are no longer masked, the most
+ * urgent first, then the pended context switch once thread code resumes
+ */
+static void
+host_servicePending( void )
+{
+	osCounter_t i, next;
+
+	for( ; ; )
+	{
+		next = pendingCount;
+
+		for( i = 0; i < pendingCount; i++ )
+		{
+			if( (pending[i].priority > interruptMask) && (pending[i].priority > interruptPriority) &&
+				( (next == pendingCount) || (pending[i].priority > pending[next].priority) ) )
+				next = i;
+		}
+
+		if( next == pendingCount )
+			break;
+
+		/* the interrupt might pend others, take it off the list first */
+		HostInterrupt_t interrupt = pending[next];
+		pending[next] = pending[--pendingCount];
+		host_runInterrupt( interrupt );
+	}
+
+	if( yieldPending && (interruptMask == 0) && (interruptPriority == 0) )
+		host_switch();
+}
+
+void
+port_disableInterrupts( void )
+{
+	host_setMask( HOST_MASK_ALL );
+}
+
+void
+port_enableInterrupts( void )
+{
+	host_setMask( 0 );
+	host_servicePending();
+}
+
+void
+port_yield( void )
+{
+	yieldPending = true;
+
+	if( (interruptMask == 0) && (interruptPriority == 0) )
+		host_switch();
+}
+
+osByte_t*
+port_makeFakeContext( osByte_t* stack, osCounter_t stackSize, osCode_t code, const void* argument )
+{
+	HostContext_t* context;
+	osByte_t* top = stack + stackSize - sizeof(HostContext_t);
+
+	/* the context goes on top of the stack, the thread uses the memory below it */
+	top -= (uintptr_t) top % 16;
+	context = (HostContext_t*) top;
+
+	getcontext( &context->context );
+	context->context.uc_stack.ss_sp = stack;
+	context->context.uc_stack.ss_size = top - stack;
+	context->context.uc_link = NULL;
+	context->code = code;
+	context->argument = argument;
+	makecontext( &context->context, host_threadEntry, 0 );
+
+	return (osByte_t*) context;
+}
+
+void
+port_startKernel( void )
+{
+	static ucontext_t mainContext;
+
+	swapcontext( &mainContext, &( (HostContext_t*) currentThread->PSP )->context );
+
+	/* the main context is never resumed */
+	abort();
+}
+
+OS_NORETURN void
+port_idle( void )
+{
+	for( ; ; )
+	{
+		if( ++idleTicks > HOST_IDLE_TICK_LIMIT )
+		{
+			fprintf( stderr, "deadlock: every thread is blocked\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		host_tickHandler();
+	}
+}
+
+#if OS_USE_INTERRUPT_CEILING
+void
+port_setInterruptMask( osCounter_t ceiling )
+{
+	host_setMask( ceiling );
+	host_servicePending();
+}
+
+osCounter_t
+port_getInterruptPriority( void )
+{
+	return interruptPriority;
+}
+#endif
+
+#if OS_USE_TICKLESS_IDLE
+osCounter_t
+port_suppressTicks( osCounter_t ticks )
+{
+	suppressCount++;
+	suppressRequest = ticks;
+
+	if( wakeUpHandler != NULL )
+	{
+		/* the interrupt is serviced after the idle thread leaves the critical section */
+		if( (ticks == 0) || (wakeUpTicks < ticks) )
+			ticks = wakeUpTicks;
+
+		host_interrupt( 1, wakeUpHandler );
+		wakeUpHandler = NULL;
+	}
+
+	if( ticks == 0 )
+	{
+		fprintf( stderr, "deadlock: every thread is blocked\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return ticks;
+}
+
+void
+port_sleep( void )
+{
+	host_tickHandler();
+}
+
+osCounter_t
+host_getSuppressCount( void )
+{
+	return suppressCount;
+}
+
+osCounter_t
+host_getSuppressRequest( void )
+{
+	return suppressRequest;
+}
+
+void
+host_wakeUpEarly( osCounter_t ticks, void (*handler)( void ) )
+{
+	wakeUpTicks = ticks;
+	wakeUpHandler = handler;
+}
+#endif
+
+osBool_t
+host_interrupt( osCounter_t priority, void (*handler)( void ) )
+{
+	HostInterrupt_t interrupt;
+	osBool_t run;
+
+	interrupt.priority = priority;
+	interrupt.handler = handler;
+
+	run = (priority > interruptMask) && (priority > interruptPriority);
+
+	if( run )
+		host_runInterrupt( interrupt );
+	else
+	{
+		if( pendingCount == HOST_PENDING_MAX )
+		{
+			fprintf( stderr, "too many pending interrupts\n" );
+			abort();
+		}
+
+		pending[pendingCount++] = interrupt;
+	}
+
+	host_servicePending();
+
+	return run;
+}
+
+osBool_t
+host_catchAssert( void (*function)( void ) )
+{
+	jmp_buf catcher;
+	osCounter_t mask = interruptMask;
+	osCounter_t priority = interruptPriority;
+	osCounter_t nesting = criticalNesting;
+
+	assertCatcher = &catcher;
+
+	if( setjmp( catcher ) == 0 )
+	{
+		function();
+		assertCatcher = NULL;
+
+		return false;
+	}
+
+	/* the assertion left the handlers and the critical sections it was called from */
+	assertCatcher = NULL;
+	criticalNesting = nesting;
+	interruptMask = mask;
+	interruptPriority = priority;
+
+	return true;
+}
+
+osCounter_t
+host_getSwitchCount( void )
+{
+	return switchCount;
+}
+
+void
+host_resetMaskedWindow( void )
+{
+	measuringMask = true;
+	longestMasked = 0;
+
+	if( interruptMask != 0 )
+		maskedSince = host_getNanoseconds();
+}
+
+unsigned long long
+host_getMaskedWindow( void )
+{
+	return longestMasked;
+}
+
+unsigned long long
+host_getNanoseconds( void )
+{
+	struct timespec now;
+
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return (unsigned long long) now.tv_sec * 1000000000ull + (unsigned long long) now.tv_nsec;
+}
+
+void
+host_assertFailed( const char* file, int line, const char* condition )
+{
+	if( assertCatcher != NULL )
+		longjmp( *assertCatcher, 1 );
+
+	fprintf( stderr, "%s:%d: assertion failed: %s\n", file, line, condition );
+	abort();
+}
+
+void
+host_check( osBool_t condition, const char* file, int line, const char* text )
+{
+	if( condition == false )
+	{
+		fprintf( stderr, "%s:%d: check failed: %s\n", file, line, text );
+		failures++;
+	}
+}
+
+void
+host_finish( void )
+{
+	if( failures != 0 )
+	{
+		fprintf( stderr, "%u check(s) failed\n", (unsigned) failures );
+		exit( EXIT_FAILURE );
+	}
+
+	exit( EXIT_SUCCESS );
+}
@@ -0,0 +1,110 @@
+/** ***********************************************************************
+ * @file
+ * @brief CPU budget tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Built with OS_USE_CPU_BUDGET. A thread that never blocks is given
+ * a budget of 3 ticks every 10 ticks. Once it used up its budget, it must
+ * drop to its background priority, beneath a thread that runs in the
+ * meantime, and it must be raised back to its priority when the budget is
+ * replenished, one period after it started to consume it. The threads
+ * consume their work by calling the tick handler, so that each tick is
+ * charged to the thread that runs, and count each tick before it occurs.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_HOG 			3
+#define PRIO_OBSERVER 		10
+#define PRIO_BACKGROUND 	20
+
+#define BUDGET 				3
+#define BUDGET_PERIOD 		10
+
+static volatile osCounter_t hogTicks;
+static volatile osCounter_t observerTicks;
+
+/**
+ * @brief Runs without ever blocking
+ */
+static void
+hogTask( const void* argument )
+{
+	for( ; ; )
+	{
+		hogTicks++;
+		host_tickHandler();
+	}
+}
+
+/**
+ * @brief Runs whenever the hog is in the background
+ */
+static void
+observerTask( const void* argument )
+{
+	for( ; ; )
+	{
+		observerTicks++;
+		host_tickHandler();
+	}
+}
+
+/**
+ * @brief The hog is demoted once its budget is used up, and promoted back
+ * when it is replenished
+ */
+static void
+testBudget( void )
+{
+	osHandle_t hog, observer;
+
+	hog = osThreadCreate( PRIO_HOG, (osCode_t) hogTask, STACK_SIZE, 0 );
+	observer = osThreadCreate( PRIO_OBSERVER, (osCode_t) observerTask, STACK_SIZE, 0 );
+	osThreadSetBudget( hog, BUDGET, BUDGET_PERIOD, PRIO_BACKGROUND );
+
+	/* the hog uses up its budget, the observer runs for the rest of the period */
+	osThreadDelay( BUDGET_PERIOD / 2 );
+	CHECK( hogTicks == BUDGET );
+	CHECK( observerTicks == BUDGET_PERIOD / 2 - BUDGET );
+	CHECK( osThreadGetPriority( hog ) == PRIO_BACKGROUND );
+	CHECK( osThreadGetBudgetOverrunCounter( hog ) == 1 );
+
+	/* the replenishment on tick 10 raises the hog back above the observer */
+	osThreadDelay( BUDGET_PERIOD / 2 + 1 );
+	CHECK( osThreadGetPriority( hog ) == PRIO_HOG );
+	CHECK( hogTicks == BUDGET + 1 );
+	CHECK( observerTicks == BUDGET_PERIOD - BUDGET );
+
+	/* and it is demoted again once the new budget is used up */
+	osThreadDelay( BUDGET );
+	CHECK( osThreadGetPriority( hog ) == PRIO_BACKGROUND );
+	CHECK( hogTicks == 2 * BUDGET );
+	CHECK( osThreadGetBudgetOverrunCounter( hog ) == 2 );
+
+	osThreadDelete( hog );
+	osThreadDelete( observer );
+}
+
+/**
+ * @brief Runs the test above the other threads
+ */
+static void
+controllerTask( const void* argument )
+{
+	testBudget();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
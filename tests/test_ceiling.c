@@ -0,0 +1,136 @@
+/** ***********************************************************************
+ * @file
+ * @brief Kernel interrupt priority ceiling tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Built with OS_USE_INTERRUPT_CEILING. An interrupt above
+ * OS_KERNEL_INTERRUPT_CEILING must run while a thread holds a critical
+ * section, one at the ceiling must wait for the critical section to exit
+ * before it calls the kernel, and a kernel call from above the ceiling must
+ * fail the assertion of the kernel.
+ *************************************************************************/
+#include "rtos.h"
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	2
+#define PRIO_WAITER 		1
+
+/* logical interrupt priorities, see OS_KERNEL_INTERRUPT_CEILING */
+#define IRQ_KERNEL 			OS_KERNEL_INTERRUPT_CEILING
+#define IRQ_FAST 			( OS_KERNEL_INTERRUPT_CEILING + 1 )
+
+static osHandle_t semaphore;
+
+static osBool_t fastRan;
+static osCounter_t fastNesting;
+static osBool_t kernelIsrRan;
+static osBool_t waiterRan;
+
+/**
+ * @brief An interrupt above the ceiling, which does not call the kernel
+ */
+static void
+fastIsr( void )
+{
+	fastRan = true;
+	fastNesting = criticalNesting;
+}
+
+/**
+ * @brief An interrupt at the ceiling, which readies the waiter
+ */
+static void
+kernelIsr( void )
+{
+	osInterruptEnter();
+	osSemaphorePost( semaphore );
+	kernelIsrRan = true;
+	osInterruptExit();
+}
+
+/**
+ * @brief Raises an interrupt above the ceiling which calls the kernel
+ */
+static void
+raiseRogueIsr( void )
+{
+	host_interrupt( IRQ_FAST, kernelIsr );
+}
+
+/**
+ * @brief Runs once the kernel interrupt posted the semaphore
+ */
+static void
+waiterTask( const void* argument )
+{
+	osSemaphoreWait( semaphore, 0 );
+	waiterRan = true;
+}
+
+/**
+ * @brief An interrupt above the ceiling is not delayed by a critical section,
+ * one at the ceiling is
+ */
+static void
+testMasking( void )
+{
+	osThreadCreate( PRIO_WAITER, (osCode_t) waiterTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( waiterRan == false );
+
+	osThreadEnterCritical();
+	{
+		CHECK( host_interrupt( IRQ_FAST, fastIsr ) );
+		CHECK( fastRan );
+		CHECK( fastNesting == 1 );
+
+		CHECK( host_interrupt( IRQ_KERNEL, kernelIsr ) == false );
+		CHECK( kernelIsrRan == false );
+	}
+	osThreadExitCritical();
+
+	/* the pending interrupt ran as the mask dropped, and the waiter it readied
+	 * preempted this thread right after */
+	CHECK( kernelIsrRan );
+	CHECK( waiterRan );
+}
+
+/**
+ * @brief A kernel call from above the ceiling fails the assertion
+ */
+static void
+testRogueIsr( void )
+{
+	kernelIsrRan = false;
+
+	CHECK( host_catchAssert( raiseRogueIsr ) );
+	CHECK( kernelIsrRan == false );
+	CHECK( criticalNesting == 0 );
+	CHECK( port_getInterruptPriority() == 0 );
+}
+
+/**
+ * @brief Runs the tests below the waiter
+ */
+static void
+controllerTask( const void* argument )
+{
+	semaphore = osSemaphoreCreate( 0 );
+
+	testMasking();
+	testRogueIsr();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
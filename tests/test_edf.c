@@ -0,0 +1,147 @@
+/** ***********************************************************************
+ * @file
+ * @brief Earliest-deadline-first scheduling tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Built with OS_USE_EDF. A task of 2 ticks every 5 ticks and a task
+ * of 4 ticks every 7 ticks use 97% of the CPU, which EDF schedules without a
+ * miss. With rate-monotonic fixed priorities, the short task preempts the
+ * long one, which then completes its first period at tick 8, after its
+ * deadline. The threads consume their work by calling the tick handler, so
+ * that each tick is charged to the thread that runs.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+
+/* the short task above the EDF priority, as rate-monotonic ordering puts it */
+#define PRIO_SHORT 			( OS_EDF_PRIORITY - 1 )
+
+#define SHORT_WORK 			2
+#define SHORT_PERIOD 		5
+#define LONG_WORK 			4
+#define LONG_PERIOD 		7
+
+/* a few hyperperiods of both tasks */
+#define HORIZON 			( 4 * SHORT_PERIOD * LONG_PERIOD )
+
+static volatile osCounter_t completed[2];
+
+/**
+ * @brief Spends the given number of ticks running
+ */
+static void
+work( osCounter_t ticks )
+{
+	while( ticks-- != 0 )
+		host_tickHandler();
+}
+
+/**
+ * @brief A periodic EDF task, the argument is the index of its task
+ */
+static void
+edfTask( const void* argument )
+{
+	osCounter_t index = (osCounter_t)(long) argument;
+
+	for( ; ; )
+	{
+		work( index == 0 ? SHORT_WORK : LONG_WORK );
+		completed[index]++;
+		osThreadWaitNextPeriod();
+	}
+}
+
+/**
+ * @brief The short task at a fixed priority
+ */
+static void
+fixedTask( const void* argument )
+{
+	osTime_t release = osGetTime();
+
+	for( ; ; )
+	{
+		work( SHORT_WORK );
+		completed[0]++;
+
+		release += SHORT_PERIOD;
+		if( release > osGetTime() )
+			osThreadDelay( (osCounter_t)( release - osGetTime() ) );
+	}
+}
+
+/**
+ * @brief Both tasks are EDF threads, no deadline is missed
+ */
+static void
+testEdf( void )
+{
+	osHandle_t shortTask, longTask;
+
+	completed[0] = completed[1] = 0;
+
+	shortTask = osThreadCreate( PRIO_CONTROLLER + 1, (osCode_t) edfTask, STACK_SIZE, (void*) 0 );
+	longTask = osThreadCreate( PRIO_CONTROLLER + 1, (osCode_t) edfTask, STACK_SIZE, (void*) 1 );
+	osThreadSetDeadline( shortTask, SHORT_PERIOD, SHORT_PERIOD );
+	osThreadSetDeadline( longTask, LONG_PERIOD, LONG_PERIOD );
+
+	osThreadDelay( HORIZON );
+
+	CHECK( completed[0] >= HORIZON / SHORT_PERIOD );
+	CHECK( completed[1] >= HORIZON / LONG_PERIOD );
+	CHECK( osThreadGetDeadlineMissCounter( shortTask ) == 0 );
+	CHECK( osThreadGetDeadlineMissCounter( longTask ) == 0 );
+
+	osThreadDelete( shortTask );
+	osThreadDelete( longTask );
+}
+
+/**
+ * @brief The short task preempts the long one at a fixed priority, the long
+ * one misses its deadlines
+ */
+static void
+testFixedPriority( void )
+{
+	osHandle_t shortTask, longTask;
+
+	completed[0] = completed[1] = 0;
+
+	shortTask = osThreadCreate( PRIO_SHORT, (osCode_t) fixedTask, STACK_SIZE, 0 );
+	longTask = osThreadCreate( PRIO_CONTROLLER + 1, (osCode_t) edfTask, STACK_SIZE, (void*) 1 );
+	osThreadSetDeadline( longTask, LONG_PERIOD, LONG_PERIOD );
+
+	osThreadDelay( HORIZON );
+
+	CHECK( completed[0] >= HORIZON / SHORT_PERIOD );
+	CHECK( osThreadGetDeadlineMissCounter( longTask ) != 0 );
+
+	osThreadDelete( shortTask );
+	osThreadDelete( longTask );
+}
+
+/**
+ * @brief Runs the tests above the tasks
+ */
+static void
+controllerTask( const void* argument )
+{
+	testEdf();
+	testFixedPriority();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
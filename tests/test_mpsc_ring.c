@@ -0,0 +1,91 @@
+/** ***********************************************************************
+ * @file
+ * @brief Multi-producer single-consumer ring tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Several producers on host threads race to claim the slots of a
+ * small ring through the atomic path, while one consumer takes the items.
+ * Every item must arrive exactly once, and the items of each producer in
+ * the order it wrote them.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define ITEM_COUNT 			16
+#define PRODUCER_COUNT 		4
+#define ITEMS_PER_PRODUCER 	100000
+
+/**
+ * @brief An item passed through the ring
+ */
+typedef struct
+{
+	osCounter_t producer;		/**< @brief the index of the producer that wrote it */
+	osCounter_t sequence;		/**< @brief its position among the items of the producer */
+} Item_t;
+
+static osHandle_t ring;
+static const struct timespec backOff = { 0, 1000 };
+
+static void*
+producerMain( void* argument )
+{
+	Item_t item;
+
+	item.producer = (osCounter_t)(long) argument;
+
+	for( item.sequence = 0; item.sequence < ITEMS_PER_PRODUCER; item.sequence++ )
+	{
+		/* let the consumer run on a single core host */
+		while( osMpscRingWrite( ring, &item ) == false )
+			nanosleep( &backOff, NULL );
+	}
+
+	return NULL;
+}
+
+int
+main( void )
+{
+	pthread_t producers[PRODUCER_COUNT];
+	osCounter_t next[PRODUCER_COUNT] = { 0 };
+	osCounter_t received = 0, i;
+	Item_t item;
+
+	osInit();
+
+	ring = osMpscRingCreate( sizeof(Item_t), ITEM_COUNT );
+
+	for( i = 0; i < PRODUCER_COUNT; i++ )
+		pthread_create( &producers[i], NULL, producerMain, (void*)(long) i );
+
+	while( received < PRODUCER_COUNT * ITEMS_PER_PRODUCER )
+	{
+		if( osMpscRingRead( ring, &item ) == false )
+		{
+			nanosleep( &backOff, NULL );
+			continue;
+		}
+
+		/* a lost, repeated or reordered item ends the test, the producers
+		 * might never finish then */
+		if( ( item.producer >= PRODUCER_COUNT ) || ( item.sequence != next[item.producer] ) )
+		{
+			CHECK( item.producer < PRODUCER_COUNT );
+			CHECK( item.sequence == next[item.producer % PRODUCER_COUNT] );
+			host_finish();
+		}
+
+		next[item.producer]++;
+		received++;
+	}
+
+	for( i = 0; i < PRODUCER_COUNT; i++ )
+		pthread_join( producers[i], NULL );
+
+	CHECK( osMpscRingRead( ring, &item ) == false );
+
+	host_finish();
+}
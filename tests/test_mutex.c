@@ -0,0 +1,195 @@
+/** ***********************************************************************
+ * @file
+ * @brief Mutex priority inheritance tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that the owner of a mutex inherits the priority of the
+ * threads waiting for it, along a chain of mutexes, that a waiter timing
+ * out takes its priority back, and that unlocking restores the priority of
+ * the owner, for both mutex types.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_HIGH_TIMEOUT 	2
+#define PRIO_HIGH 			3
+#define PRIO_MIDDLE 		6
+#define PRIO_LOW 			10
+
+static osHandle_t first, second, recursive, gate;
+static osHandle_t low, middle, high;
+
+static osCounter_t lowAfterFirstUnlock;
+static osCounter_t lowAfterUnlock;
+static osCounter_t middleAfterUnlock;
+static osBool_t highTimeoutResult = true;
+static osBool_t highResult;
+
+/**
+ * @brief Locks the first mutex and keeps it until the gate opens
+ */
+static void
+lowTask( const void* argument )
+{
+	osMutexLock( first, 0 );
+	osSemaphoreWait( gate, 0 );
+	osMutexUnlock( first );
+
+	lowAfterUnlock = osThreadGetPriority( 0 );
+}
+
+/**
+ * @brief Locks the second mutex, then waits for the first one
+ */
+static void
+middleTask( const void* argument )
+{
+	osMutexLock( second, 0 );
+	osMutexLock( first, 0 );
+	osMutexUnlock( first );
+	osMutexUnlock( second );
+
+	middleAfterUnlock = osThreadGetPriority( 0 );
+}
+
+/**
+ * @brief Waits for the second mutex, and gives up after a few ticks
+ */
+static void
+highTimeoutTask( const void* argument )
+{
+	highTimeoutResult = osMutexLock( second, 5 );
+}
+
+/**
+ * @brief Waits for the second mutex
+ */
+static void
+highTask( const void* argument )
+{
+	highResult = osMutexLock( second, 0 );
+	osMutexUnlock( second );
+}
+
+/**
+ * @brief Locks the recursive mutex twice and keeps it until the gate opens
+ */
+static void
+recursiveLowTask( const void* argument )
+{
+	osRecursiveMutexLock( recursive, 0 );
+	osRecursiveMutexLock( recursive, 0 );
+	osSemaphoreWait( gate, 0 );
+
+	osRecursiveMutexUnlock( recursive );
+	lowAfterFirstUnlock = osThreadGetPriority( 0 );
+
+	osRecursiveMutexUnlock( recursive );
+	lowAfterUnlock = osThreadGetPriority( 0 );
+}
+
+/**
+ * @brief Waits for the recursive mutex
+ */
+static void
+recursiveHighTask( const void* argument )
+{
+	highResult = osRecursiveMutexLock( recursive, 0 );
+	osRecursiveMutexUnlock( recursive );
+}
+
+/**
+ * @brief Low waits with the first mutex, middle waits for it with the second
+ * mutex, and two high threads wait for the second mutex in turn
+ */
+static void
+testChain( void )
+{
+	low = osThreadCreate( PRIO_LOW, (osCode_t) lowTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( osThreadGetPriority( low ) == PRIO_LOW );
+
+	/* inversion, low runs at the priority of middle */
+	middle = osThreadCreate( PRIO_MIDDLE, (osCode_t) middleTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( osThreadGetPriority( middle ) == PRIO_MIDDLE );
+	CHECK( osThreadGetPriority( low ) == PRIO_MIDDLE );
+
+	/* the priority is passed on along the chain */
+	osThreadCreate( PRIO_HIGH_TIMEOUT, (osCode_t) highTimeoutTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( osThreadGetPriority( middle ) == PRIO_HIGH_TIMEOUT );
+	CHECK( osThreadGetPriority( low ) == PRIO_HIGH_TIMEOUT );
+
+	/* and taken back along the chain when the waiter times out */
+	osThreadDelay( 10 );
+	CHECK( highTimeoutResult == false );
+	CHECK( osThreadGetPriority( middle ) == PRIO_MIDDLE );
+	CHECK( osThreadGetPriority( low ) == PRIO_MIDDLE );
+
+	high = osThreadCreate( PRIO_HIGH, (osCode_t) highTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( osThreadGetPriority( middle ) == PRIO_HIGH );
+	CHECK( osThreadGetPriority( low ) == PRIO_HIGH );
+
+	/* every owner drops back to its own priority as soon as it unlocks */
+	osSemaphorePost( gate );
+	osThreadDelay( 10 );
+	CHECK( highResult );
+	CHECK( middleAfterUnlock == PRIO_MIDDLE );
+	CHECK( lowAfterUnlock == PRIO_LOW );
+	CHECK( osThreadGetPriority( middle ) == PRIO_MIDDLE );
+	CHECK( osThreadGetPriority( low ) == PRIO_LOW );
+}
+
+/**
+ * @brief The owner keeps the inherited priority until the last unlock
+ */
+static void
+testRecursive( void )
+{
+	highResult = false;
+	lowAfterUnlock = 0;
+
+	low = osThreadCreate( PRIO_LOW, (osCode_t) recursiveLowTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+
+	high = osThreadCreate( PRIO_HIGH, (osCode_t) recursiveHighTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+	CHECK( osThreadGetPriority( low ) == PRIO_HIGH );
+
+	osSemaphorePost( gate );
+	osThreadDelay( 10 );
+	CHECK( highResult );
+	CHECK( lowAfterFirstUnlock == PRIO_HIGH );
+	CHECK( lowAfterUnlock == PRIO_LOW );
+}
+
+/**
+ * @brief Runs the tests above every other thread
+ */
+static void
+controllerTask( const void* argument )
+{
+	first = osMutexCreate();
+	second = osMutexCreate();
+	recursive = osRecursiveMutexCreate();
+	gate = osSemaphoreCreate( 0 );
+
+	testChain();
+	testRecursive();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/** ***********************************************************************
+ * @file
+ * @brief Priority ceiling mutex tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that the owner of a mutex with a priority ceiling runs at
+ * the ceiling as soon as it locks it, so that a thread beneath the ceiling
+ * readied meanwhile only runs after the unlock, that the owner gets its
+ * priority back, and that a thread above the ceiling locking the mutex
+ * fails the assertion of the kernel.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_CEILING 		4
+#define PRIO_MIDDLE 		6
+#define PRIO_OWNER 			10
+
+static osHandle_t mutex, wake;
+
+static osBool_t middleRan;
+static osCounter_t ownerWhileHeld;
+static osBool_t middleRanWhileHeld;
+static osBool_t middleRanAfterUnlock;
+static osCounter_t ownerAfterUnlock;
+
+/**
+ * @brief Runs beneath the ceiling once the owner wakes it
+ */
+static void
+middleTask( const void* argument )
+{
+	osSemaphoreWait( wake, 0 );
+	middleRan = true;
+}
+
+/**
+ * @brief Wakes the middle thread while it holds the mutex
+ */
+static void
+ownerTask( const void* argument )
+{
+	osMutexLock( mutex, 0 );
+	ownerWhileHeld = osThreadGetPriority( 0 );
+
+	osSemaphorePost( wake );
+	middleRanWhileHeld = middleRan;
+
+	osMutexUnlock( mutex );
+	middleRanAfterUnlock = middleRan;
+	ownerAfterUnlock = osThreadGetPriority( 0 );
+}
+
+/**
+ * @brief Locks the mutex from above the ceiling
+ */
+static void
+lockAboveCeiling( void )
+{
+	osMutexLock( mutex, 0 );
+}
+
+/**
+ * @brief The owner runs at the ceiling until it unlocks the mutex
+ */
+static void
+testOwner( void )
+{
+	osThreadCreate( PRIO_MIDDLE, (osCode_t) middleTask, STACK_SIZE, 0 );
+	osThreadCreate( PRIO_OWNER, (osCode_t) ownerTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+
+	CHECK( ownerWhileHeld == PRIO_CEILING );
+	CHECK( middleRanWhileHeld == false );
+	CHECK( middleRanAfterUnlock );
+	CHECK( ownerAfterUnlock == PRIO_OWNER );
+}
+
+/**
+ * @brief A thread above the ceiling must not lock the mutex
+ */
+static void
+testAboveCeiling( void )
+{
+	CHECK( host_catchAssert( lockAboveCeiling ) );
+
+	/* the mutex is left unlocked, and the thread at its priority */
+	CHECK( osMutexPeekLock( mutex ) );
+	CHECK( osThreadGetPriority( 0 ) == PRIO_CONTROLLER );
+}
+
+/**
+ * @brief Runs the tests above the ceiling
+ */
+static void
+controllerTask( const void* argument )
+{
+	mutex = osMutexCreateCeiling( PRIO_CEILING );
+	wake = osSemaphoreCreate( 0 );
+
+	testOwner();
+	testAboveCeiling();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+/** ***********************************************************************
+ * @file
+ * @brief Queue zero-copy region tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that a region reserved across the end of the queue memory
+ * is split in two pieces that continue each other, that the data written
+ * into it reaches a blocked reader on commit, that an acquired region reads
+ * back the same way, and that a second region is refused, as well as the
+ * copying functions, while one is outstanding.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <string.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	2
+#define PRIO_READER 		1
+
+#define REGION_SIZE 		6
+#define REGION_WRAP 		2
+
+static const osByte_t data[REGION_SIZE] = { 'a', 'b', 'c', 'd', 'e', 'f' };
+
+static osHandle_t queue;
+static osCounter_t memorySize;
+
+static osByte_t received[REGION_SIZE];
+static osBool_t readerResult;
+
+/**
+ * @brief Receives one region worth of data
+ */
+static void
+readerTask( const void* argument )
+{
+	readerResult = osQueueReceive( queue, received, REGION_SIZE, 0 );
+}
+
+/**
+ * @brief Moves the read and write positions to where a region wraps
+ */
+static void
+moveToWrap( void )
+{
+	osByte_t buffer[64];
+	osCounter_t size = memorySize - (REGION_SIZE - REGION_WRAP);
+
+	/* both positions start at 0 after a reset */
+	osQueueReset( queue );
+
+	while( size != 0 )
+	{
+		osCounter_t piece = size < sizeof(buffer) ? size : sizeof(buffer);
+
+		CHECK( osQueueSendNonBlock( queue, buffer, piece ) );
+		CHECK( osQueueReceiveNonBlock( queue, buffer, piece ) );
+		size -= piece;
+	}
+}
+
+/**
+ * @brief Checks that a region wraps around the end of the queue memory
+ */
+static void
+checkWrapped( const osQueueRegion_t* region )
+{
+	CHECK( region->firstSize == REGION_SIZE - REGION_WRAP );
+	CHECK( region->secondSize == REGION_WRAP );
+	CHECK( (osByte_t*) region->second + memorySize == (osByte_t*) region->first + region->firstSize );
+}
+
+/**
+ * @brief Reserves a wrapping region, fills it and commits it to a blocked reader
+ */
+static void
+testReserve( void )
+{
+	osQueueRegion_t region, other;
+
+	moveToWrap();
+
+	osThreadCreate( PRIO_READER, (osCode_t) readerTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+
+	CHECK( osQueueSendReserve( queue, REGION_SIZE, &region ) );
+	checkWrapped( &region );
+
+	/* the space behind the reserved region is not available to anyone else */
+	CHECK( osQueueSendReserve( queue, 1, &other ) == false );
+	CHECK( osQueueSendNonBlock( queue, data, 1 ) == false );
+	CHECK( osQueueGetFreeSize( queue ) == 0 );
+	CHECK( osQueueGetUsedSize( queue ) == 0 );
+
+	memcpy( region.first, data, region.firstSize );
+	memcpy( region.second, data + region.firstSize, region.secondSize );
+	osQueueSendCommit( queue, REGION_SIZE );
+
+	/* the reader preempted on commit */
+	CHECK( readerResult );
+	CHECK( memcmp( received, data, REGION_SIZE ) == 0 );
+	CHECK( osQueueGetUsedSize( queue ) == 0 );
+}
+
+/**
+ * @brief Acquires wrapping data in place and releases it
+ */
+static void
+testAcquire( void )
+{
+	osQueueRegion_t region, other;
+	osByte_t byte;
+
+	moveToWrap();
+	CHECK( osQueueSendNonBlock( queue, data, REGION_SIZE ) );
+
+	CHECK( osQueueReceiveAcquire( queue, REGION_SIZE, &region ) );
+	checkWrapped( &region );
+	CHECK( memcmp( region.first, data, region.firstSize ) == 0 );
+	CHECK( memcmp( region.second, data + region.firstSize, region.secondSize ) == 0 );
+
+	/* the data behind the acquired region is not available to anyone else */
+	CHECK( osQueueReceiveAcquire( queue, 1, &other ) == false );
+	CHECK( osQueueReceiveNonBlock( queue, &byte, 1 ) == false );
+
+	osQueueReceiveRelease( queue, REGION_SIZE );
+	CHECK( osQueueGetUsedSize( queue ) == 0 );
+	CHECK( osQueueGetFreeSize( queue ) == memorySize - 1 );
+}
+
+/**
+ * @brief Runs the tests beneath the reader
+ */
+static void
+controllerTask( const void* argument )
+{
+	queue = osQueueCreate( 32 );
+	memorySize = osQueueGetSize( queue ) + 1;
+
+	testReserve();
+	testAcquire();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
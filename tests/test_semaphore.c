@@ -0,0 +1,133 @@
+/** ***********************************************************************
+ * @file
+ * @brief Semaphore atomic fast path tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Posts and non-blocking waits race on several host cores through
+ * the atomic fast path, and no count may be lost or made up. Then threads
+ * of the kernel block on the semaphore, which sends the posts through the
+ * kernel until the last waiter is served.
+ *************************************************************************/
+#include "rtos.h"
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#include <pthread.h>
+
+#define STACK_SIZE 			65536
+
+#define POSTER_COUNT 		4
+#define WAITER_COUNT 		4
+#define POSTS_PER_POSTER 	200000
+
+static osHandle_t semaphore;
+static volatile osCounter_t taken;
+
+static void*
+posterMain( void* argument )
+{
+	osCounter_t i;
+
+	for( i = 0; i < POSTS_PER_POSTER; i++ )
+		osSemaphorePost( semaphore );
+
+	return NULL;
+}
+
+static void*
+waiterMain( void* argument )
+{
+	while( taken < POSTER_COUNT * POSTS_PER_POSTER )
+	{
+		if( osSemaphoreWaitNonBlock( semaphore ) )
+			__sync_fetch_and_add( &taken, 1 );
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Races posts against non-blocking waits before the kernel starts
+ */
+static void
+testFastPath( void )
+{
+	pthread_t posters[POSTER_COUNT], waiters[WAITER_COUNT];
+	osCounter_t i;
+
+	semaphore = osSemaphoreCreate( 0 );
+
+	for( i = 0; i < WAITER_COUNT; i++ )
+		pthread_create( &waiters[i], NULL, waiterMain, NULL );
+
+	for( i = 0; i < POSTER_COUNT; i++ )
+		pthread_create( &posters[i], NULL, posterMain, NULL );
+
+	for( i = 0; i < POSTER_COUNT; i++ )
+		pthread_join( posters[i], NULL );
+
+	for( i = 0; i < WAITER_COUNT; i++ )
+		pthread_join( waiters[i], NULL );
+
+	CHECK( taken == POSTER_COUNT * POSTS_PER_POSTER );
+	CHECK( osSemaphoreGetCounter( semaphore ) == 0 );
+	CHECK( osSemaphoreWaitNonBlock( semaphore ) == false );
+}
+
+static volatile osCounter_t served;
+
+static void
+waitingTask( const void* argument )
+{
+	if( osSemaphoreWait( semaphore, 0 ) )
+		served++;
+}
+
+/**
+ * @brief Blocks threads on the semaphore, and hands the posts to them
+ */
+static void
+controllerTask( const void* argument )
+{
+	Semaphore_t* control = (Semaphore_t*) semaphore;
+
+	osThreadCreate( 2, (osCode_t) waitingTask, STACK_SIZE, 0 );
+	osThreadCreate( 2, (osCode_t) waitingTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+
+	/* the posts have to go through the kernel while threads wait */
+	CHECK( control->counter == SEMAPHORE_CONTENDED );
+	CHECK( osSemaphoreGetCounter( semaphore ) == 0 );
+
+	osSemaphorePost( semaphore );
+	osThreadDelay( 1 );
+	CHECK( served == 1 );
+	CHECK( control->counter == SEMAPHORE_CONTENDED );
+
+	osSemaphorePost( semaphore );
+	osThreadDelay( 1 );
+	CHECK( served == 2 );
+
+	/* the post that finds no thread waiting counts again, and the fast path is back */
+	osSemaphorePost( semaphore );
+	osSemaphorePost( semaphore );
+	CHECK( control->counter == 2 );
+	CHECK( osSemaphoreWaitNonBlock( semaphore ) );
+	CHECK( osSemaphoreWaitNonBlock( semaphore ) );
+	CHECK( osSemaphoreWaitNonBlock( semaphore ) == false );
+	CHECK( osSemaphoreWait( semaphore, 3 ) == false );
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+
+	testFastPath();
+
+	osThreadCreate( 1, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+/** ***********************************************************************
+ * @file
+ * @brief Single-producer single-consumer ring tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details A producer and a consumer on two host threads stream a byte
+ * sequence through a small ring in chunks of varying sizes, so that the
+ * positions wrap around at every offset. The consumer must read the
+ * sequence back unchanged.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define RING_SIZE 			61
+#define STREAM_SIZE 		1000000
+#define CHUNK_MAX 			23
+
+static osHandle_t ring;
+static const struct timespec backOff = { 0, 1000 };
+static volatile osCounter_t mismatches;
+
+/**
+ * @brief Returns the byte at a position of the sequence
+ */
+static osByte_t
+sequence( osCounter_t position )
+{
+	return (osByte_t)( position * 7 + position / 251 );
+}
+
+static void*
+producerMain( void* argument )
+{
+	osByte_t chunk[CHUNK_MAX];
+	osCounter_t position = 0, size, written, i;
+
+	while( position < STREAM_SIZE )
+	{
+		size = 1 + position % CHUNK_MAX;
+		if( size > STREAM_SIZE - position )
+			size = STREAM_SIZE - position;
+
+		for( i = 0; i < size; i++ )
+			chunk[i] = sequence( position + i );
+
+		/* a full ring takes only part of the chunk */
+		written = osSpscRingWrite( ring, chunk, size );
+		position += written;
+
+		/* let the consumer run on a single core host */
+		if( written == 0 )
+			nanosleep( &backOff, NULL );
+	}
+
+	return NULL;
+}
+
+static void*
+consumerMain( void* argument )
+{
+	osByte_t chunk[CHUNK_MAX];
+	osCounter_t position = 0, size, read, i;
+
+	while( position < STREAM_SIZE )
+	{
+		size = 1 + ( position / 3 ) % CHUNK_MAX;
+
+		read = osSpscRingRead( ring, chunk, size );
+		CHECK( read <= size );
+
+		for( i = 0; i < read; i++ )
+		{
+			if( chunk[i] != sequence( position + i ) )
+				mismatches++;
+		}
+
+		position += read;
+
+		if( read == 0 )
+			nanosleep( &backOff, NULL );
+	}
+
+	return NULL;
+}
+
+int
+main( void )
+{
+	pthread_t producer, consumer;
+
+	osInit();
+
+	ring = osSpscRingCreate( RING_SIZE );
+
+	pthread_create( &consumer, NULL, consumerMain, NULL );
+	pthread_create( &producer, NULL, producerMain, NULL );
+
+	pthread_join( producer, NULL );
+	pthread_join( consumer, NULL );
+
+	CHECK( mismatches == 0 );
+	CHECK( osSpscRingGetUsedSize( ring ) == 0 );
+
+	host_finish();
+}
@@ -0,0 +1,143 @@
+/** ***********************************************************************
+ * @file
+ * @brief Stream buffer tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that a blocked reader is readied once the trigger level is
+ * reached, that a reader whose wait times out below the trigger level still
+ * receives the bytes that arrived, and that deleting the stream buffer
+ * readies a blocked reader with nothing.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#include <string.h>
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_READER 		5
+
+#define TRIGGER_LEVEL 		8
+#define READ_SIZE 			16
+#define READ_TIMEOUT 		5
+
+static osHandle_t stream;
+
+static osByte_t received[READ_SIZE];
+static osCounter_t receivedSize;
+static osBool_t readerDone;
+
+/**
+ * @brief Receives once from the stream buffer
+ */
+static void
+readerTask( const void* argument )
+{
+	receivedSize = osStreamReceive( stream, received, READ_SIZE, READ_TIMEOUT );
+	readerDone = true;
+}
+
+/**
+ * @brief Starts a reader, which blocks on the empty stream buffer
+ */
+static void
+startReader( void )
+{
+	memset( received, 0, sizeof(received) );
+	receivedSize = 0;
+	readerDone = false;
+
+	osThreadCreate( PRIO_READER, (osCode_t) readerTask, STACK_SIZE, 0 );
+	osThreadDelay( 1 );
+}
+
+/**
+ * @brief The reader is readied once the trigger level arrives
+ */
+static void
+testTrigger( void )
+{
+	static const osByte_t data[] = "abcdefghij";
+
+	startReader();
+
+	CHECK( osStreamSend( stream, data, 3 ) == 3 );
+	osThreadDelay( 1 );
+	CHECK( readerDone == false );
+
+	CHECK( osStreamSend( stream, data + 3, 7 ) == 7 );
+	osThreadDelay( 1 );
+	CHECK( readerDone );
+	CHECK( receivedSize == 10 );
+	CHECK( memcmp( received, data, 10 ) == 0 );
+	CHECK( osStreamGetUsedSize( stream ) == 0 );
+}
+
+/**
+ * @brief A short last frame is received when the wait times out
+ */
+static void
+testTimeout( void )
+{
+	static const osByte_t data[] = "xyz";
+
+	startReader();
+
+	CHECK( osStreamSend( stream, data, 3 ) == 3 );
+	osThreadDelay( 1 );
+	CHECK( readerDone == false );
+
+	osThreadDelay( READ_TIMEOUT + 2 );
+	CHECK( readerDone );
+	CHECK( receivedSize == 3 );
+	CHECK( memcmp( received, data, 3 ) == 0 );
+	CHECK( osStreamGetUsedSize( stream ) == 0 );
+
+	/* nothing arrived at all */
+	startReader();
+	osThreadDelay( READ_TIMEOUT + 2 );
+	CHECK( readerDone );
+	CHECK( receivedSize == 0 );
+}
+
+/**
+ * @brief A reader blocked on a deleted stream buffer receives nothing
+ */
+static void
+testDelete( void )
+{
+	static const osByte_t data[] = "pq";
+
+	startReader();
+
+	CHECK( osStreamSend( stream, data, 2 ) == 2 );
+	osStreamDelete( stream );
+	osThreadDelay( 1 );
+	CHECK( readerDone );
+	CHECK( receivedSize == 0 );
+}
+
+/**
+ * @brief Runs the tests above the reader
+ */
+static void
+controllerTask( const void* argument )
+{
+	stream = osStreamCreate( 32, TRIGGER_LEVEL );
+
+	testTrigger();
+	testTimeout();
+	testDelete();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
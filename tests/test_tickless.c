@@ -0,0 +1,112 @@
+/** ***********************************************************************
+ * @file
+ * @brief Tickless idle tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Built with OS_USE_TICKLESS_IDLE. The idle thread must stop the
+ * tick for as many ticks as the earliest timeout is away, and the system
+ * time must catch up with the ticks skipped, so that the thread wakes on
+ * its tick. An interrupt that ends the sleep early must wake its thread on
+ * the tick it arrived, and short idle periods keep the tick running.
+ *************************************************************************/
+#include "rtos.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+
+#define LONG_DELAY 			50
+#define EARLY_WAKE_UP 		10
+
+static osHandle_t semaphore;
+
+/**
+ * @brief Wakes the controller before its wait times out
+ */
+static void
+wakeUpIsr( void )
+{
+	osInterruptEnter();
+	osSemaphorePost( semaphore );
+	osInterruptExit();
+}
+
+/**
+ * @brief A long delay is slept in one go, and ends on its tick
+ */
+static void
+testLongSleep( void )
+{
+	osCounter_t count = host_getSuppressCount();
+	osTime_t start = osGetTime();
+
+	osThreadDelay( LONG_DELAY );
+
+	CHECK( host_getSuppressCount() == count + 1 );
+	CHECK( host_getSuppressRequest() == LONG_DELAY );
+	CHECK( osGetTime() == start + LONG_DELAY );
+}
+
+/**
+ * @brief An interrupt ends the sleep early, the time advances only by the
+ * ticks slept
+ */
+static void
+testEarlyWakeUp( void )
+{
+	osCounter_t count = host_getSuppressCount();
+	osTime_t start = osGetTime();
+
+	host_wakeUpEarly( EARLY_WAKE_UP, wakeUpIsr );
+
+	CHECK( osSemaphoreWait( semaphore, LONG_DELAY ) );
+	CHECK( host_getSuppressCount() == count + 1 );
+	CHECK( host_getSuppressRequest() == LONG_DELAY );
+	CHECK( osGetTime() == start + EARLY_WAKE_UP );
+
+	/* the timeout of the wait is gone, the next sleep is a whole delay */
+	start = osGetTime();
+	osThreadDelay( LONG_DELAY );
+	CHECK( host_getSuppressRequest() == LONG_DELAY );
+	CHECK( osGetTime() == start + LONG_DELAY );
+}
+
+/**
+ * @brief A delay shorter than OS_TICKLESS_MIN_IDLE_TICKS keeps the tick
+ */
+static void
+testShortSleep( void )
+{
+	osCounter_t count = host_getSuppressCount();
+	osTime_t start = osGetTime();
+
+	osThreadDelay( OS_TICKLESS_MIN_IDLE_TICKS - 1 );
+
+	CHECK( host_getSuppressCount() == count );
+	CHECK( osGetTime() == start + OS_TICKLESS_MIN_IDLE_TICKS - 1 );
+}
+
+/**
+ * @brief Runs the tests, the idle thread runs whenever it blocks
+ */
+static void
+controllerTask( const void* argument )
+{
+	semaphore = osSemaphoreCreate( 0 );
+
+	testLongSleep();
+	testEarlyWakeUp();
+	testShortSleep();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
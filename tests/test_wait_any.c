@@ -0,0 +1,135 @@
+/** ***********************************************************************
+ * @file
+ * @brief Wait for multiple objects tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that osWaitAny returns the index of an object that is
+ * already ready without blocking, the index of the object that readies a
+ * blocked waiter, and OS_WAIT_ANY_NONE once the wait times out. Whichever
+ * way the wait ends, the waiter must be taken out of the selectors of
+ * every object, including the ones that did not fire.
+ *************************************************************************/
+#include "rtos.h"
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#define STACK_SIZE 			65536
+
+#define PRIO_CONTROLLER 	1
+#define PRIO_POSTER 		5
+
+#define WAIT_TIMEOUT 		5
+
+#define OBJECT_COUNT 		3
+#define INDEX_SEMAPHORE 	0
+#define INDEX_MESSAGE_QUEUE 1
+#define INDEX_SIGNAL 		2
+
+static osWaitObject_t objects[OBJECT_COUNT];
+static osHandle_t semaphore, messageQueue, signal;
+
+/**
+ * @brief Readies the controller through the message queue
+ */
+static void
+posterTask( const void* argument )
+{
+	osCounter_t message = 1;
+
+	osMessageQueueSendNonBlock( messageQueue, &message );
+}
+
+/**
+ * @brief Checks that no thread is left in the selectors of any object
+ */
+static void
+checkNoSelectors( void )
+{
+	CHECK( ( (Semaphore_t*) semaphore )->selectors.first == NULL );
+	CHECK( ( (MessageQueue_t*) messageQueue )->selectors.first == NULL );
+	CHECK( ( (Signal_t*) signal )->selectors.first == NULL );
+}
+
+/**
+ * @brief The wait times out when no object becomes ready
+ */
+static void
+testTimeout( void )
+{
+	osTime_t start = osGetTime();
+
+	CHECK( osWaitAny( objects, OBJECT_COUNT, WAIT_TIMEOUT ) == OS_WAIT_ANY_NONE );
+	CHECK( osGetTime() == start + WAIT_TIMEOUT );
+	checkNoSelectors();
+}
+
+/**
+ * @brief A ready object is reported without blocking
+ */
+static void
+testAlreadyReady( void )
+{
+	osTime_t start = osGetTime();
+
+	osSemaphorePost( semaphore );
+
+	CHECK( osWaitAny( objects, OBJECT_COUNT, WAIT_TIMEOUT ) == INDEX_SEMAPHORE );
+	CHECK( osGetTime() == start );
+	CHECK( osSemaphoreWaitNonBlock( semaphore ) );
+	checkNoSelectors();
+}
+
+/**
+ * @brief The object that readies the waiter is reported, and the waiter leaves
+ * the selectors of the other objects
+ */
+static void
+testWokenByOther( void )
+{
+	osCounter_t message = 0;
+
+	osThreadCreate( PRIO_POSTER, (osCode_t) posterTask, STACK_SIZE, 0 );
+
+	CHECK( osWaitAny( objects, OBJECT_COUNT, 0 ) == INDEX_MESSAGE_QUEUE );
+	checkNoSelectors();
+
+	CHECK( osMessageQueueReceiveNonBlock( messageQueue, &message ) );
+	CHECK( message == 1 );
+
+	/* a later post finds nobody to ready */
+	osSemaphorePost( semaphore );
+	CHECK( osSemaphoreGetCounter( semaphore ) == 1 );
+}
+
+/**
+ * @brief Runs the tests above the poster
+ */
+static void
+controllerTask( const void* argument )
+{
+	semaphore = osSemaphoreCreate( 0 );
+	messageQueue = osMessageQueueCreate( sizeof(osCounter_t), 2 );
+	signal = osSignalCreate();
+
+	objects[INDEX_SEMAPHORE].handle = semaphore;
+	objects[INDEX_SEMAPHORE].type = OSOBJECT_SEMAPHORE;
+	objects[INDEX_MESSAGE_QUEUE].handle = messageQueue;
+	objects[INDEX_MESSAGE_QUEUE].type = OSOBJECT_MESSAGE_QUEUE;
+	objects[INDEX_SIGNAL].handle = signal;
+	objects[INDEX_SIGNAL].type = OSOBJECT_SIGNAL;
+
+	testTimeout();
+	testAlreadyReady();
+	testWokenByOther();
+
+	host_finish();
+}
+
+int
+main( void )
+{
+	osInit();
+	osThreadCreate( PRIO_CONTROLLER, (osCode_t) controllerTask, STACK_SIZE, 0 );
+	osStart();
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+/** ***********************************************************************
+ * @file
+ * @brief Timing wheel tests
+ * @author John Doe (jdoe35087@gmail.com)
+ * @details Checks that every item of a timing wheel is taken exactly on its
+ * wake up tick when the lower word of the system time wraps around, when
+ * the item is several revolutions of the wheel away, and when the time
+ * advances by more ticks than the wheel has slots.
+ *************************************************************************/
+#include "includes/portable.h"
+#include "portable/host.h"
+
+#define ITEM_COUNT 		8
+
+/**
+ * @brief An item in the wheel under test
+ */
+typedef struct
+{
+	PrioritizedListItem_t listItem;		/**< @brief the item in the wheel */
+	osTime_t wakeUp;					/**< @brief the tick it should be taken on */
+	osTime_t taken;						/**< @brief the tick it was taken on, 0 if not yet */
+	osCounter_t takenCount;				/**< @brief the number of times it was taken */
+} Item_t;
+
+static TimingWheel_t wheel;
+static Item_t items[ITEM_COUNT];
+static osCounter_t itemCount;
+
+/**
+ * @brief Empties the wheel and sets the system time
+ * @param now the system time the test starts at
+ */
+static void
+reset( osTime_t now )
+{
+	timingWheel_init( &wheel );
+	systemTime = now;
+	itemCount = 0;
+}
+
+/**
+ * @brief Inserts an item into the wheel
+ * @param delay the wake up time relative to the system time, which may be
+ * negative for a wake up time in the past
+ * @param wakeUp the tick the item should be taken on
+ */
+static void
+insert( long long delay, osTime_t wakeUp )
+{
+	Item_t* item = &items[itemCount++];
+
+	prioritizedList_itemInit( &item->listItem, item, 0 );
+	item->wakeUp = wakeUp;
+	item->taken = 0;
+	item->takenCount = 0;
+
+	timingWheel_insert( &wheel, &item->listItem, (osCounter_t)( systemTime + delay ) );
+}
+
+/**
+ * @brief Advances the system time and takes the items that woke up
+ * @param ticks the number of ticks to advance at once
+ */
+static void
+advance( osCounter_t ticks )
+{
+	NotPrioritizedList_t expired;
+	Item_t* item;
+
+	notPrioritizedList_init( &expired );
+
+	systemTime += ticks;
+	timingWheel_takeExpired( &wheel, ticks, &expired );
+
+	while( expired.first != NULL )
+	{
+		item = (Item_t*) expired.first->container;
+		list_remove( expired.first );
+
+		item->taken = systemTime;
+		item->takenCount++;
+	}
+}
+
+/**
+ * @brief Checks that every item was taken once, on its wake up tick
+ */
+static void
+checkTaken( void )
+{
+	osCounter_t i;
+
+	for( i = 0; i < itemCount; i++ )
+	{
+		CHECK( items[i].takenCount == 1 );
+		CHECK( items[i].taken == items[i].wakeUp );
+		CHECK( items[i].listItem.list == NULL );
+	}
+}
+
+/**
+ * @brief Advances one tick at a time across a wrap of the lower word
+ */
+static void
+testWrapAround( osTime_t start )
+{
+	osCounter_t tick;
+
+	reset( start );
+
+	/* a wake up time in the past, or now, is taken on the next tick */
+	insert( -3, start + 1 );
+	insert( 0, start + 1 );
+	insert( 5, start + 5 );
+
+	/* after the wrap, in the first revolution and three revolutions later */
+	insert( 20, start + 20 );
+	insert( 3 * OS_TIMING_WHEEL_SIZE + 7, start + 3 * OS_TIMING_WHEEL_SIZE + 7 );
+
+	/* same slot as the previous item, one revolution earlier */
+	insert( 2 * OS_TIMING_WHEEL_SIZE + 7, start + 2 * OS_TIMING_WHEEL_SIZE + 7 );
+
+	for( tick = 0; tick < 4 * OS_TIMING_WHEEL_SIZE; tick++ )
+		advance( 1 );
+
+	checkTaken();
+}
+
+/**
+ * @brief Advances by more ticks than the wheel has slots at once, as after a
+ * long tickless idle period
+ */
+static void
+testClamping( void )
+{
+	reset( 1000 );
+
+	insert( 1, 1050 );
+	insert( OS_TIMING_WHEEL_SIZE - 1, 1050 );
+	insert( OS_TIMING_WHEEL_SIZE + 8, 1050 );
+	insert( 50, 1050 );
+
+	/* one revolution after the slot of the jump target, and far beyond it */
+	insert( 50 + OS_TIMING_WHEEL_SIZE, 1050 + OS_TIMING_WHEEL_SIZE );
+	insert( 100, 1110 );
+
+	advance( 50 );
+
+	CHECK( items[4].takenCount == 0 );
+	CHECK( items[5].takenCount == 0 );
+
+	advance( OS_TIMING_WHEEL_SIZE );
+	advance( 1110 - 1050 - OS_TIMING_WHEEL_SIZE );
+
+	checkTaken();
+}
+
+int
+main( void )
+{
+	osInit();
+
+	osThreadEnterCritical();
+	{
+		testWrapAround( 0xFFFFFFF0ULL );
+		testWrapAround( 0x1FFFFFFF8ULL );
+		testClamping();
+	}
+	osThreadExitCritical();
+
+	host_finish();
+}